@@ -0,0 +1,175 @@
+/*
+ * MMLcompiler.h
+ * -----------------------------------------------
+ * Compile-time MML compiler.
+ *
+ * Turns an MML string literal into a PROGMEM array of pre-decoded events, which
+ *    MMLtone can play without parsing any text during the clock ticks.
+ * Each event is a 16 bits word (see MMLEVT_* in MMLtone.h) holding :
+ *  - the index of the note (see pitches.h)
+ *  - the amount of ticks the note lasts (dotted durations included)
+ *  - the clear-cut flag
+ * Tempo changes (T<bpm>) and repeated sections ([ and ]n) are held in events of
+ *    pitch MMLEVT_TEMPO, MMLEVT_LOOP and MMLEVT_REPEAT, their argument taking the
+ *    place of the ticks and clear-cut flag. Repeats are played by MMLtone, the
+ *    section is stored only once.
+ *
+ * The compiler follows exactly the rules of MMLtone::decode() (sticky octave and
+ *    duration, sharps and flats, dotted notes, clear-cuts), and splits the code
+ *    in the same way as MMLtone::getNextNote() does.
+ *
+ * Usage :
+ *    MML_COMPILE(melodyevents, "4D4 G2 G8 B8 A8 B8 G2./");
+ *    MMLtone melody = MMLtone(12, melodyevents::events, melodyevents::count);
+ *
+ * The code is checked by the validator first (see MMLvalidator.h), so that
+ *    malformed code fails the build instead of playing garbage.
+ *
+ * Everything is evaluated by the compiler (C++11 constexpr), the decoding code
+ *    itself does not end up in the firmware.
+ * The song is walked in halves down to single characters : the recursion depth grows
+ *    as log2 of its size (16 calls for 65535 bytes), so that songs of any length compile
+ *    within the default -fconstexpr-depth. Each event is found by going down the halves
+ *    holding it, which are the same for every event.
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#ifndef MMLCOMPILER_H_INCLUDED
+#define MMLCOMPILER_H_INCLUDED
+
+#include <Arduino.h>
+#include "MMLtone.h"
+#include "pitches.h"
+#include "MMLsequence.h"
+#include "MMLtoken.h"
+#include "MMLvalidator.h"
+
+/****************************************************************
+ * State of the compilation after a character                   *
+ ****************************************************************/
+struct MMLcursor{
+  unsigned int  tokens;     //amount of tokens started so far
+  unsigned int  run;        //amount of characters since the last separator
+  unsigned char octave;     //octave in use
+  unsigned char duration;   //duration in use (in ticks)
+
+  constexpr MMLcursor(const unsigned int n = 0, const unsigned int r = 0,
+                      const unsigned char oct = 0, const unsigned char dur = MMLDEFTICKS)
+  :tokens(n), run(r), octave(oct), duration(dur)
+  {}
+
+  static constexpr bool separator(const char c){
+    return (c == ' ' || c == '\0');
+  }
+
+  //whether a token starts at the character c : after a separator, or every NOTBUFSZ - 1
+  //  characters of a note too long (same rules as getNextNote(), which splits it)
+  constexpr bool starts(const char c) const{
+    return (separator(c) ? !run : !(run % (NOTBUFSZ - 1)));
+  }
+
+  constexpr unsigned int nextRun(const char c) const{
+    return (separator(c) ? 0 : run + 1);
+  }
+
+  //state after the character c, inside a token
+  constexpr MMLcursor skip(const char c) const{
+    return MMLcursor(tokens, nextRun(c), octave, duration);
+  }
+
+  //state after the character c, starting the token t
+  constexpr MMLcursor read(const char c, const MMLtoken& t) const{
+    return MMLcursor(tokens + 1, nextRun(c), t.octave(octave), t.duration(duration));
+  }
+};
+
+/****************************************************************
+ * Functions walking through an MML string                      *
+ ****************************************************************/
+struct MMLcompiler{
+  //amount of bytes read for the token starting at pos, separator included
+  //  (same rules as getNextNote(), a note too long being split)
+  static constexpr unsigned int length(const char* code, const unsigned int size, const unsigned int pos, const unsigned int i = 0){
+    return (pos + i >= size ? i
+          : code[pos + i] == ' ' || code[pos + i] == '\0' ? i + 1
+          : i >= NOTBUFSZ - 1 ? i
+          : length(code, size, pos, i + 1));
+  }
+
+  static constexpr MMLtoken token(const char* code, const unsigned int size, const unsigned int pos){
+    return MMLtoken(code, pos, length(code, size, pos));
+  }
+
+  //state after the characters from lo to hi (excluded), given the state at lo
+  //  (the range is split in halves, so that the recursion depth grows as log2 of the size of the code)
+  static constexpr MMLcursor walk(const char* code, const unsigned int size, const unsigned int lo, const unsigned int hi, const MMLcursor cursor){
+    return (hi - lo > 1 ? walk(code, size, lo + (hi - lo) / 2, hi, walk(code, size, lo, lo + (hi - lo) / 2, cursor))
+          : lo >= hi ? cursor
+          : cursor.starts(code[lo]) ? cursor.read(code[lo], token(code, size, lo))
+          : cursor.skip(code[lo]));
+  }
+
+  //event of the token n, starting between lo and hi (excluded), given the state at lo
+  //  (the halves walked are the same for every token, the compiler evaluating each of them once)
+  static constexpr uint16_t find(const char* code, const unsigned int size, const unsigned int n,
+                                 const unsigned int lo, const unsigned int hi, const MMLcursor cursor){
+    return (hi - lo <= 1 ? token(code, size, lo).event(cursor.octave, cursor.duration)
+          : half(code, size, n, lo, lo + (hi - lo) / 2, hi, cursor, walk(code, size, lo, lo + (hi - lo) / 2, cursor)));
+  }
+
+  //event of the token n, in the half of the range holding it
+  static constexpr uint16_t half(const char* code, const unsigned int size, const unsigned int n, const unsigned int lo,
+                                 const unsigned int mid, const unsigned int hi, const MMLcursor cursor, const MMLcursor middle){
+    return (n < middle.tokens ? find(code, size, n, lo, mid, cursor)
+          : find(code, size, n, mid, hi, middle));
+  }
+
+  //amount of tokens in the code
+  static constexpr unsigned int count(const char* code, const unsigned int size){
+    return walk(code, size, 0, size, MMLcursor()).tokens;
+  }
+
+  //event of the token n, with the octave and duration in use after the tokens before
+  static constexpr uint16_t compile(const char* code, const unsigned int size, const unsigned int n){
+    return find(code, size, n, 0, size, MMLcursor());
+  }
+};
+
+/****************************************************************
+ * Event of the token N of an MML source, as a constant of its  *
+ *    own (GCC then evaluates each half of the code only once   *
+ *    for all the events, instead of once per event)            *
+ ****************************************************************/
+template<class Source, unsigned int N>
+struct MMLcompiledEvent{
+  static constexpr uint16_t value = MMLcompiler::compile(Source::code(), Source::size(), N);
+};
+
+/****************************************************************
+ * Events compiled from an MML source (see MML_COMPILE)         *
+ ****************************************************************/
+template<class Source, class Sequence = typename MMLmakeSequence<MMLcompiler::count(Source::code(), Source::size())>::type>
+struct MMLcompiled;
+
+template<class Source, unsigned int... I>
+struct MMLcompiled<Source, MMLsequence<I...> >{
+  static_assert(sizeof...(I) > 0, "MML code must hold at least one note");
+
+  static const unsigned int count = sizeof...(I);
+  static constexpr uint16_t events[sizeof...(I)] PROGMEM = {MMLcompiledEvent<Source, I>::value...};
+};
+
+template<class Source, unsigned int... I>
+constexpr uint16_t MMLcompiled<Source, MMLsequence<I...> >::events[sizeof...(I)] PROGMEM;
+
+//declares a type holding the events compiled from an MML string literal
+#define MML_COMPILE(name, mml) \
+  struct name##_source{ \
+    static constexpr const char* code(){ return mml; } \
+    static constexpr unsigned int size(){ return sizeof(mml); } \
+  }; \
+  MML_VALIDATE(mml); \
+  typedef MMLcompiled<name##_source> name
+#endif
@@ -0,0 +1,302 @@
+/*
+ * MMLcontrol.cpp
+ * -----------------------------------------------
+ * Controls an MMLtone melody from loop() without any critical section.
+ *
+ * Instead of calling start(), stop(), reset()... while the timer ISR is playing the
+ *    melody, loop() posts commands (play, stop, pause, resume, seek a note or a bar, change song)
+ *    in a lock-free ring. The ISR calls onTick() instead of getNextNote()/onTick(),
+ *    which executes the commands waiting on a tick boundary before playing the tick.
+ * Only loop() posts commands, and only the ISR executes them (single producer,
+ *    single consumer) : the indexes of the ring are each written by one side only,
+ *    so neither cli() nor sei() is needed.
+ *
+ * After each tick, the ISR publishes a status snapshot (flags and position), which
+ *    loop() reads with status(). A version counter guarantees that the snapshot is
+ *    never read half-written.
+ * The melody is stopped (noTone()) as soon as its last note has been played.
+ *
+ * Usage :
+ *    ISR(TIMER1_COMPA_vect){ if(melody.clock()) control.onTick(); }
+ *    void loop(){ if(control.status().flags & MMLSTS_FINISHED) control.play(); }
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#include "MMLcontrol.h"
+
+#define QUEUEMASK (MMLQUEUESZ - 1)
+
+/****************************************************************
+ * I : Melody to control                                        *
+ * P : Builds a new controller, with an empty queue             *
+ * O : /                                                        *
+ ****************************************************************/
+MMLcontrol::MMLcontrol(MMLtone& melody)
+:m_melody(&melody), m_commands{}, m_head(0), m_tail(0), m_sequence(0), m_flags(0), m_position(0)
+{}
+
+/****************************************************************
+ * I : Command (see MMLCMD_*)                                   *
+ *     Numeric argument                                         *
+ *     Song (change song commands)                              *
+ * P : Post a command to the ISR (to be called from loop())     *
+ * O : true if posted, false if the queue is full               *
+ ****************************************************************/
+bool MMLcontrol::post(const unsigned char type, const unsigned int arg, const void* ptr){
+  unsigned char head = this->m_head;
+  if((unsigned char)(head - this->m_tail) >= MMLQUEUESZ)
+    return false;
+
+  MMLcommand* command = this->m_commands + (head & QUEUEMASK);
+  command->type = type;
+  command->arg = arg;
+  command->ptr = ptr;
+
+  //publish the command to onTick()
+  MMLBARRIER();
+  this->m_head = head + 1;
+  return true;
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Rewind the melody and play it                            *
+ * O : true if posted, false if the queue is full               *
+ ****************************************************************/
+bool MMLcontrol::play(){
+  return this->post(MMLCMD_PLAY);
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Stop the melody and rewind it                            *
+ * O : true if posted, false if the queue is full               *
+ ****************************************************************/
+bool MMLcontrol::stop(){
+  return this->post(MMLCMD_STOP);
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Stop the melody where it is                              *
+ * O : true if posted, false if the queue is full               *
+ ****************************************************************/
+bool MMLcontrol::pause(){
+  return this->post(MMLCMD_PAUSE);
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Play the melody from where it has been paused            *
+ * O : true if posted, false if the queue is full               *
+ ****************************************************************/
+bool MMLcontrol::resume(){
+  return this->post(MMLCMD_RESUME);
+}
+
+/****************************************************************
+ * I : Index of a note in the MML code (or of an event)         *
+ * P : Play the melody from the given note                      *
+ * O : true if posted, false if the queue is full               *
+ ****************************************************************/
+bool MMLcontrol::seek(const unsigned int pos){
+  return this->post(MMLCMD_SEEK, pos);
+}
+
+/****************************************************************
+ * I : Bar to reach (0 for the first one, see MMLBARTICKS)      *
+ *     Index of the song (kept until the command is executed)   *
+ * P : Play the melody from the beginning of the bar            *
+ *     (only through an index : the ISR walks a few tokens from *
+ *     the last checkpoint before it, never the whole song)     *
+ * O : true if posted, false if the queue is full               *
+ ****************************************************************/
+bool MMLcontrol::seekToBar(const unsigned int bar, const MMLindex& index){
+  return this->post(MMLCMD_BAR, bar, &index);
+}
+
+/****************************************************************
+ * I : Pointer to the MML string                                *
+ *     Size of the code array (sizeof())                        *
+ * P : Replace the song (played right away if the melody was)   *
+ * O : true if posted, false if the queue is full               *
+ ****************************************************************/
+bool MMLcontrol::change(const char* code, const unsigned int siz){
+  return this->post(MMLCMD_CODE, siz, code);
+}
+
+/****************************************************************
+ * I : Pointer to the pre-decoded events (see MMLcompiler.h)    *
+ *     Amount of events                                         *
+ * P : Replace the song (played right away if the melody was)   *
+ * O : true if posted, false if the queue is full               *
+ ****************************************************************/
+bool MMLcontrol::change(const uint16_t* events, const unsigned int count){
+  return this->post(MMLCMD_EVENTS, count, events);
+}
+
+/****************************************************************
+ * I : Pointer to the packed song (see MMLpacked.h)             *
+ *     Size of the packed song (sizeof())                       *
+ * P : Replace the song (played right away if the melody was)   *
+ * O : true if posted, false if the queue is full               *
+ ****************************************************************/
+bool MMLcontrol::change(const uint8_t* packed, const unsigned int siz){
+  return this->post(MMLCMD_PACKED, siz, packed);
+}
+
+/****************************************************************
+ * I : Source providing the MML code (see MMLsource.h)          *
+ * P : Replace the song (played right away if the melody was)   *
+ * O : true if posted, false if the queue is full               *
+ ****************************************************************/
+bool MMLcontrol::change(MMLsource& source){
+  return this->post(MMLCMD_SOURCE, 0, &source);
+}
+
+/****************************************************************
+ * I : Songs to play one after the other (see MMLplaylist.h)    *
+ * P : Replace the song (played right away if the melody was)   *
+ * O : true if posted, false if the queue is full               *
+ ****************************************************************/
+bool MMLcontrol::change(MMLplaylist& playlist){
+  return this->post(MMLCMD_PLAYLIST, 0, &playlist);
+}
+
+/****************************************************************/
+/*  I : /                                                       */
+/*  P : When a tick is reached, execute the commands posted,    */
+/*      play the tick and publish the status (ISR only)         */
+/*  O : /                                                       */
+/****************************************************************/
+void MMLcontrol::onTick(){
+  //execute the commands posted since the last tick,
+  //  releasing each slot to post() once done
+  unsigned char tail = this->m_tail;
+  while(tail != this->m_head)
+  {
+    MMLBARRIER();
+    this->execute(this->m_commands[tail & QUEUEMASK]);
+    tail++;
+    MMLBARRIER();
+    this->m_tail = tail;
+  }
+
+  this->m_melody->getNextNote();
+  this->m_melody->onTick();
+
+  //silence the melody once its last note has been played
+  if(this->m_melody->finished() && this->m_melody->started())
+    this->m_melody->stop();
+
+  this->publish();
+}
+
+/****************************************************************/
+/*  I : Command to execute                                      */
+/*  P : Apply a command to the melody (ISR only)                */
+/*  O : /                                                       */
+/****************************************************************/
+void MMLcontrol::execute(const MMLcommand& command){
+  const bool playing = this->m_melody->started();
+
+  switch(command.type){
+    case MMLCMD_PLAY:
+        this->m_melody->reset();
+        this->m_melody->start();
+        break;
+
+    case MMLCMD_STOP:
+        this->m_melody->stop();
+        this->m_melody->reset();
+        break;
+
+    case MMLCMD_PAUSE:
+        this->m_melody->stop();
+        break;
+
+    case MMLCMD_RESUME:
+        this->m_melody->start();
+        break;
+
+    case MMLCMD_SEEK:
+        this->m_melody->seek(command.arg);
+        break;
+
+    case MMLCMD_BAR:
+        if(!command.ptr)
+          return;
+        this->m_melody->seekToBar(command.arg, *(const MMLindex*)command.ptr);
+        break;
+
+    case MMLCMD_CODE:
+        this->m_melody->load((const char*)command.ptr, command.arg);
+        break;
+
+    case MMLCMD_EVENTS:
+        this->m_melody->load((const uint16_t*)command.ptr, command.arg);
+        break;
+
+    case MMLCMD_SOURCE:
+        this->m_melody->load(*(MMLsource*)command.ptr);
+        break;
+
+    case MMLCMD_PLAYLIST:
+        this->m_melody->load(*(MMLplaylist*)command.ptr);
+        break;
+
+    case MMLCMD_PACKED:
+        this->m_melody->load((const uint8_t*)command.ptr, command.arg);
+        break;
+
+    default:
+        return;
+  }
+
+  //a new song keeps on playing if the previous one was
+  if(((command.type >= MMLCMD_CODE && command.type <= MMLCMD_PLAYLIST) || command.type == MMLCMD_PACKED) && playing)
+    this->m_melody->start();
+}
+
+/****************************************************************/
+/*  I : /                                                       */
+/*  P : Publish the status of the melody (ISR only)             */
+/*  O : /                                                       */
+/****************************************************************/
+void MMLcontrol::publish(){
+  unsigned char flags = 0;
+  if(this->m_melody->started())
+    flags |= MMLSTS_STARTED;
+  if(this->m_melody->finished())
+    flags |= MMLSTS_FINISHED;
+  if(this->m_melody->last())
+    flags |= MMLSTS_LAST;
+
+  //odd version while the snapshot is being written
+  this->m_sequence++;
+  this->m_flags = flags;
+  this->m_position = this->m_melody->position();
+  this->m_sequence++;
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Read the status last published by the ISR                *
+ *     (to be called from loop())                               *
+ * O : Status snapshot                                          *
+ ****************************************************************/
+MMLstatus MMLcontrol::status(){
+  MMLstatus snapshot;
+  unsigned char version;
+
+  //read again if the ISR published a new status in the meantime
+  do{
+    version = this->m_sequence;
+    snapshot.flags = this->m_flags;
+    snapshot.position = this->m_position;
+  }while((version & 1) || version != this->m_sequence);
+
+  return snapshot;
+}
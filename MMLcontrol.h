@@ -0,0 +1,70 @@
+#ifndef MMLCONTROL_H_INCLUDED
+#define MMLCONTROL_H_INCLUDED
+
+#include "MMLtone.h"
+
+#define MMLQUEUESZ    4         //amount of commands waiting for the ISR (power of 2, at most 128)
+
+//commands posted to the ISR
+#define MMLCMD_PLAY   0         //rewind and play
+#define MMLCMD_STOP   1         //stop and rewind
+#define MMLCMD_PAUSE  2         //stop where the melody is
+#define MMLCMD_RESUME 3         //play from where the melody has been paused
+#define MMLCMD_SEEK   4         //play from another note (argument : index of the note)
+#define MMLCMD_CODE   5         //change song (MML code, argument : size)
+#define MMLCMD_EVENTS 6         //change song (pre-decoded events, argument : amount)
+#define MMLCMD_SOURCE 7         //change song (MMLsource)
+#define MMLCMD_PLAYLIST 8       //change song (MMLplaylist)
+#define MMLCMD_BAR    9         //play from the beginning of a bar (argument : bar, MMLindex)
+#define MMLCMD_PACKED 10        //change song (packed song, argument : size)
+
+//flags of the status snapshot
+#define MMLSTS_STARTED  0x01    //melody playing
+#define MMLSTS_FINISHED 0x02    //last note played
+#define MMLSTS_LAST     0x04    //last note being played
+
+//command waiting in the queue
+struct MMLcommand{
+  unsigned char       type;                 //command (see MMLCMD_*)
+  unsigned int        arg;                  //numeric argument
+  const void*         ptr;                  //song (change song commands)
+};
+
+//status of the melody, as published by the ISR after a tick
+struct MMLstatus{
+  unsigned char       flags;                //state (see MMLSTS_*)
+  unsigned int        position;             //index of the note being played
+};
+
+class MMLcontrol
+{
+  private:
+      MMLtone*        m_melody;             //melody controlled
+      MMLcommand      m_commands[MMLQUEUESZ];   //commands posted by loop(), executed by the ISR
+      volatile unsigned char m_head;        //amount of commands posted (modulo 256)
+      volatile unsigned char m_tail;        //amount of commands executed (modulo 256)
+      volatile unsigned char m_sequence;    //status version (odd while being written)
+      volatile unsigned char m_flags;       //state published (see MMLSTS_*)
+      volatile unsigned int  m_position;    //position published
+
+      bool post(const unsigned char type, const unsigned int arg = 0, const void* ptr = 0);
+      void execute(const MMLcommand& command);
+      void publish();
+
+  public:
+      MMLcontrol(MMLtone& melody);
+      bool play();
+      bool stop();
+      bool pause();
+      bool resume();
+      bool seek(const unsigned int pos);
+      bool seekToBar(const unsigned int bar, const MMLindex& index);
+      bool change(const char* code, const unsigned int siz);
+      bool change(const uint16_t* events, const unsigned int count);
+      bool change(const uint8_t* packed, const unsigned int siz);
+      bool change(MMLsource& source);
+      bool change(MMLplaylist& playlist);
+      void onTick();
+      MMLstatus status();
+};
+#endif
@@ -0,0 +1,185 @@
+/*
+ * MMLenvelope.cpp
+ * -----------------------------------------------
+ * Attack, decay, sustain and release (ADSR) volume envelope of a melody.
+ *
+ * The envelope is an output of its own, placed between the melody and an output
+ *    able to vary its volume (e.g. MMLpwmOutput, which sets the duty cycle of the wave) :
+ *      MMLpwmOutput pwm;
+ *      MMLenvelope envelope(pwm);
+ *      melody.setOutput(envelope);
+ * Each note played starts the attack from the current volume up to full volume,
+ *    then the decay down to the sustain level, held until the note changes.
+ * A muted note (clear-cut, stop()) fades out during the release before being muted.
+ *
+ * The parameters are set from the MML code, e.g. @A8 @D4 @S160 @R12 :
+ * - @A, @D and @R are rates (1 to 255) in 1/16 of a volume step per clock() call :
+ *   a full rise or fall lasts 4080 / rate calls (16 ms to 4 s at 1 kHz). 0 is instantaneous.
+ * - @S is the volume held after the decay (0 to 255, full volume).
+ * By default, the notes are played at full volume at once and muted at once,
+ *    so that the output is never given any volume change.
+ *
+ * The volume is computed incrementally in 8.8 fixed point by clock(), which is to be
+ *    called at a fixed rate, faster than the ticks (e.g. MMLCLOCKHZ, next to MMLtone::clock()) :
+ *      ISR(TIMER1_COMPA_vect){ envelope.clock(); if(melody.clock()){ ... } }
+ * Each call costs one addition and one comparison at most, plus a call to the output
+ *    when the volume changes by a whole step : the work is constant, whatever the song.
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#include "MMLenvelope.h"
+
+/****************************************************************
+ * I : Output playing the notes, able to vary its volume        *
+ * P : Builds a new envelope, at full volume at once            *
+ * O : /                                                        *
+ ****************************************************************/
+MMLenvelope::MMLenvelope(MMLoutput& output)
+:m_output(&output), m_level(0), m_params{0, 0, 0xFF, 0}, m_phase(MMLPHASE_IDLE), m_pin(0), m_volume(0xFF)
+{}
+
+/****************************************************************
+ * I : Pin on which the buzzer is plugged                       *
+ * P : Set the output up                                        *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLenvelope::begin(const unsigned char pin){
+  this->m_pin = pin;
+  this->m_output->begin(pin);
+}
+
+/****************************************************************
+ * I : Pin on which the buzzer is plugged                       *
+ *     Index of the note (see pitches.h)                        *
+ *     Ratio of the detune (see MMLpitch::ratio())              *
+ * P : Start the attack of a note, from the current volume      *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLenvelope::play(const unsigned char pin, const unsigned char note, const uint16_t ratio){
+  this->m_pin = pin;
+
+  //instantaneous attack : straight to full volume
+  if(this->m_params[MMLENV_ATTACK])
+    this->m_phase = MMLPHASE_ATTACK;
+  else
+  {
+    this->m_level = MMLENVFULL;
+    this->m_phase = MMLPHASE_DECAY;
+  }
+
+  //volume set before the note starts, so that it does not click
+  this->apply();
+  this->m_output->play(pin, note, ratio);
+}
+
+/****************************************************************
+ * I : Pin on which the buzzer is plugged                       *
+ * P : Start the release of the note (muted at once if none)    *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLenvelope::mute(const unsigned char pin){
+  this->m_pin = pin;
+
+  if(this->m_params[MMLENV_RELEASE] && this->m_level)
+  {
+    this->m_phase = MMLPHASE_RELEASE;
+    return;
+  }
+
+  this->m_level = 0;
+  this->m_phase = MMLPHASE_IDLE;
+  this->m_output->mute(pin);
+}
+
+/****************************************************************
+ * I : Pin on which the buzzer is plugged                       *
+ *     Parameter (see MMLENV_*)                                 *
+ *     Rate, or volume for the sustain level                    *
+ * P : Change a parameter, from the next clock() call on        *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLenvelope::envelope(const unsigned char pin, const unsigned char param, const unsigned char value){
+  (void)pin;
+  if(param <= MMLENV_RELEASE)
+    this->m_params[param] = value;
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Advance the envelope by one step (to be called at a      *
+ *     fixed rate, e.g. MMLCLOCKHZ)                             *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLenvelope::clock(){
+  const uint16_t sustain = (uint16_t)this->m_params[MMLENV_SUSTAIN] << 8;
+  uint16_t rate;
+
+  //a rate of 0 (or set to 0 meanwhile) ends the phase at once
+  switch(this->m_phase){
+    case MMLPHASE_ATTACK:
+        rate = (uint16_t)this->m_params[MMLENV_ATTACK] << MMLENVSHIFT;
+        if(!rate || MMLENVFULL - this->m_level <= rate)
+        {
+          this->m_level = MMLENVFULL;
+          this->m_phase = MMLPHASE_DECAY;
+        }
+        else
+          this->m_level += rate;
+        break;
+
+    //held at the sustain level afterwards
+    case MMLPHASE_DECAY:
+        rate = (uint16_t)this->m_params[MMLENV_DECAY] << MMLENVSHIFT;
+        if(!rate || this->m_level <= sustain || this->m_level - sustain <= rate)
+        {
+          this->m_level = (this->m_level < sustain ? this->m_level : sustain);
+          this->m_phase = MMLPHASE_IDLE;
+        }
+        else
+          this->m_level -= rate;
+        break;
+
+    //the note is muted once silent
+    case MMLPHASE_RELEASE:
+        rate = (uint16_t)this->m_params[MMLENV_RELEASE] << MMLENVSHIFT;
+        if(!rate || this->m_level <= rate)
+        {
+          this->m_level = 0;
+          this->m_phase = MMLPHASE_IDLE;
+          this->m_output->mute(this->m_pin);
+          return;
+        }
+        this->m_level -= rate;
+        break;
+
+    default:
+        return;
+  }
+
+  this->apply();
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Give the volume to the output, if changed by a step      *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLenvelope::apply(){
+  const unsigned char volume = this->m_level >> 8;
+  if(volume == this->m_volume)
+    return;
+
+  this->m_volume = volume;
+  this->m_output->volume(this->m_pin, volume);
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Get the current volume                                   *
+ * O : Volume (0 to 255)                                        *
+ ****************************************************************/
+unsigned char MMLenvelope::level(){
+  return this->m_level >> 8;
+}
@@ -0,0 +1,41 @@
+#ifndef MMLENVELOPE_H_INCLUDED
+#define MMLENVELOPE_H_INCLUDED
+
+#include <stdint.h>
+#include "MMLoutput.h"
+
+#define MMLENVSHIFT   4         //rates are in 1/16 of a volume step per clock() call
+#define MMLENVFULL    0xFF00    //full volume (8.8 fixed point)
+
+//phases of an envelope
+#define MMLPHASE_IDLE     0     //silent, or held at the sustain level
+#define MMLPHASE_ATTACK   1     //rising towards full volume
+#define MMLPHASE_DECAY    2     //falling towards the sustain level
+#define MMLPHASE_RELEASE  3     //falling towards silence, the note being muted
+
+/****************************************************************
+ * Attack, decay, sustain and release volume envelope, applied  *
+ *    to the notes played through another output                *
+ ****************************************************************/
+class MMLenvelope : public MMLoutput
+{
+  private:
+      MMLoutput*      m_output;             //output playing the notes, at the volume computed
+      uint16_t        m_level;              //current volume (8.8 fixed point)
+      unsigned char   m_params[4];          //attack, decay and release rates, sustain level (see MMLENV_*)
+      unsigned char   m_phase;              //phase of the envelope (see MMLPHASE_*)
+      unsigned char   m_pin;                //pin of the last note played
+      unsigned char   m_volume;             //last volume given to the output
+
+      void apply();
+
+  public:
+      MMLenvelope(MMLoutput& output);
+      void begin(const unsigned char pin);
+      void play(const unsigned char pin, const unsigned char note, const uint16_t ratio);
+      void mute(const unsigned char pin);
+      void envelope(const unsigned char pin, const unsigned char param, const unsigned char value);
+      void clock();
+      unsigned char level();
+};
+#endif
@@ -0,0 +1,87 @@
+/*
+ * MMLindex.cpp
+ * -----------------------------------------------
+ * Checkpoints of a song, used to resume playback anywhere in it (see MMLtone::seekToTick()).
+ *
+ * Each checkpoint holds the tick at which a token starts, its index and the octave,
+ *    duration and tempo in use at that point (MMLDEFTEMPO before the first T of the song,
+ *    as the song is always started at that tempo). Seeking looks the last checkpoint before
+ *    the tick up with a binary search, then only walks the notes from there.
+ * Checkpoints are only taken outside of the repeated sections, as the stack of
+ *    sections is not stored : a long section can leave a wider gap between two of them.
+ *
+ * The index is either built at run time in RAM by MMLtone::index(), or offline
+ *    by extras/host/index.cpp, which prints it as a PROGMEM array :
+ *      const MMLcheckpoint melodyindex[] PROGMEM = { {0, 0, 0, 16, 120}, ... };
+ *      MMLindex index(melodyindex, sizeof(melodyindex) / sizeof(MMLcheckpoint), true);
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#include "MMLindex.h"
+#include "MMLtone.h"
+
+/****************************************************************
+ * I : Checkpoints, sorted by tick                              *
+ *     Amount of checkpoints                                    *
+ *     Flag indicating whether they are stored as PROGMEM       *
+ * P : Builds a new index                                       *
+ * O : /                                                        *
+ ****************************************************************/
+MMLindex::MMLindex(const MMLcheckpoint* checkpoints, const unsigned int count, const bool progmem)
+:m_checkpoints(checkpoints), m_count(count), isProgmem(progmem)
+{}
+
+/****************************************************************
+ * I : Index of the checkpoint                                  *
+ * P : Copy a checkpoint out of RAM or PROGMEM                  *
+ * O : Checkpoint                                               *
+ ****************************************************************/
+MMLcheckpoint MMLindex::at(const unsigned int i) const{
+  MMLcheckpoint checkpoint;
+
+  if(this->isProgmem)
+    memcpy_P(&checkpoint, this->m_checkpoints + i, sizeof(MMLcheckpoint));
+  else
+    checkpoint = this->m_checkpoints[i];
+
+  return checkpoint;
+}
+
+/****************************************************************
+ * I : Tick to reach                                            *
+ * P : Look the last checkpoint at or before the tick up        *
+ *     (binary search)                                          *
+ * O : Checkpoint, or the beginning of the song if none         *
+ ****************************************************************/
+MMLcheckpoint MMLindex::find(const unsigned long tick) const{
+  MMLcheckpoint found = {0, 0, 0, MMLDEFTICKS, MMLDEFTEMPO};
+  unsigned int low = 0, high = this->m_count;
+
+  //invariant : the checkpoints below low are at or before the tick, the ones from high on are after it
+  while(low < high)
+  {
+    const unsigned int middle = low + ((high - low) >> 1);
+    const MMLcheckpoint checkpoint = this->at(middle);
+
+    if(checkpoint.tick <= tick)
+    {
+      found = checkpoint;
+      low = middle + 1;
+    }
+    else
+      high = middle;
+  }
+
+  return found;
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Get the amount of checkpoints                            *
+ * O : Amount of checkpoints                                    *
+ ****************************************************************/
+unsigned int MMLindex::count() const{
+  return this->m_count;
+}
@@ -0,0 +1,36 @@
+#ifndef MMLINDEX_H_INCLUDED
+#define MMLINDEX_H_INCLUDED
+
+#include <Arduino.h>
+#include "MMLtempo.h"
+
+#ifndef MMLBARTICKS
+#define MMLBARTICKS   MMLRESOLUTION             //ticks per bar (a whole note, 4/4)
+#endif
+
+//state of a song at a note boundary, from which playback can resume
+struct MMLcheckpoint{
+  unsigned long       tick;                 //amount of ticks played before the checkpoint
+  unsigned int        pos;                  //index of the next token in the MML code (or of the next event)
+  unsigned char       octave;               //octave in use at that point
+  unsigned char       duration;             //duration (in ticks) in use at that point
+  unsigned int        bpm;                  //last tempo set by the song so far (MMLDEFTEMPO if none, 0 to keep the one in use instead)
+};
+
+/****************************************************************
+ * Checkpoints of a song, sorted by tick (see MMLtone::index()) *
+ ****************************************************************/
+class MMLindex
+{
+  private:
+      const MMLcheckpoint* m_checkpoints;   //checkpoints, in RAM or PROGMEM
+      unsigned int    m_count;              //amount of checkpoints
+      bool            isProgmem;            //flag indicating whether the checkpoints are stored as PROGMEM
+
+  public:
+      MMLindex(const MMLcheckpoint* checkpoints, const unsigned int count, const bool progmem = false);
+      MMLcheckpoint at(const unsigned int i) const;
+      MMLcheckpoint find(const unsigned long tick) const;
+      unsigned int count() const;
+};
+#endif
@@ -0,0 +1,74 @@
+/*
+ * MMLoutput.cpp
+ * -----------------------------------------------
+ * Outputs producing the notes played by MMLtone.
+ *
+ * MMLtone only hands over the index of each note (see pitches.h) and when to mute,
+ *    the output turns them into a signal on the pin :
+ * - MMLtoneOutput calls Arduino's tone() and noTone(), on any pin. It is used by default.
+ *   Each call to tone() looks the frequency up, then computes the prescaler and the compare
+ *   value of timer2 with a division, and reconfigures the timer.
+ * - MMLtimer2Output (AVR only) drives timer2 directly. The prescaler and compare value of
+ *   every note are computed at compile time in a PROGMEM table, and the square wave is
+ *   toggled by the timer itself on OC2A (D11 on Uno and Nano, other pins are ignored) :
+ *   a note change is a table read and four register writes, and no interrupt is used.
+ *   The lowest notes (below 31 Hz at 16 MHz) are played at the lowest frequency available.
+ *   As tone() also uses timer2, both can not be used together.
+ * - MMLpwmOutput (AVR only) drives timer2 in fast PWM mode on OC2B (D3 on Uno and Nano) instead,
+ *   from another PROGMEM table : the volume given by an envelope (see MMLenvelope.h) sets the
+ *   duty cycle of the wave, 50 % at full volume, down to nothing at 0.
+ *   The notes below 61 Hz (at 16 MHz) are played at the lowest frequency available.
+ *
+ * Any other output (another timer, a DAC, a recording for the host tools...)
+ *    can be given to MMLtone::setOutput().
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#include "MMLoutput.h"
+
+MMLtoneOutput MMLdefaultOutput;
+
+/****************************************************************
+ * I : Pin on which the buzzer is plugged                       *
+ * P : Set the pin as an output                                 *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLtoneOutput::begin(const unsigned char pin){
+  pinMode((int)pin, OUTPUT);
+}
+
+#ifdef __AVR__
+/****************************************************************
+ * I : Pin on which the buzzer is plugged (OC2A)                *
+ * P : Set OC2A as a low output and stop timer2                 *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLtimer2Output::begin(const unsigned char pin){
+  (void)pin;
+  DDRB |= (1 << DDB3);
+  PORTB &= ~(1 << PORTB3);
+
+  TIMSK2 = 0;
+  TCCR2A = 0;
+  TCCR2B = 0;
+}
+
+
+/****************************************************************
+ * I : Pin on which the buzzer is plugged (OC2B)                *
+ * P : Set OC2B as a low output and stop timer2                 *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLpwmOutput::begin(const unsigned char pin){
+  (void)pin;
+  DDRD |= (1 << DDD3);
+  PORTD &= ~(1 << PORTD3);
+
+  TIMSK2 = 0;
+  TCCR2A = 0;
+  TCCR2B = 0;
+}
+
+#endif
@@ -0,0 +1,248 @@
+#ifndef MMLOUTPUT_H_INCLUDED
+#define MMLOUTPUT_H_INCLUDED
+
+#include <Arduino.h>
+#include "pitches.h"
+
+//parameters of a volume envelope (see MMLenvelope.h)
+#define MMLENV_ATTACK   0       //rise rate from silence to full volume
+#define MMLENV_DECAY    1       //fall rate from full volume to the sustain level
+#define MMLENV_SUSTAIN  2       //volume held until the note is muted
+#define MMLENV_RELEASE  3       //fall rate from the sustain level to silence, once muted
+#define MMLENV_NONE     0xFF    //unknown parameter
+
+/****************************************************************
+ * Interface of the output producing the notes of a melody      *
+ *    (notes are indexes of pitches.h, NBNOTES or more if none, *
+ *    detuned by the ratio given, MMLUNITY if none)             *
+ ****************************************************************/
+class MMLoutput
+{
+  public:
+      virtual void begin(const unsigned char pin) = 0;
+      virtual void play(const unsigned char pin, const unsigned char note, const uint16_t ratio) = 0;
+      virtual void mute(const unsigned char pin) = 0;
+
+      //outputs which can not vary their volume, or have no envelope, ignore these
+      virtual void volume(const unsigned char pin, const unsigned char level){ (void)pin; (void)level; }
+      virtual void envelope(const unsigned char pin, const unsigned char param, const unsigned char value){ (void)pin; (void)param; (void)value; }
+};
+
+/****************************************************************
+ * Arduino tone() and noTone(), on any pin (default output)     *
+ ****************************************************************/
+class MMLtoneOutput : public MMLoutput
+{
+  public:
+      void begin(const unsigned char pin);
+
+      //declared as inline so that MMLstaticTone can inline them (see MMLstaticTone.h)
+      inline void play(const unsigned char pin, const unsigned char note, const uint16_t ratio);
+      inline void mute(const unsigned char pin);
+};
+
+/****************************************************************
+ * I : Pin on which the buzzer is plugged                       *
+ *     Index of the note (see pitches.h)                        *
+ *     Ratio of the detune (see MMLpitch::ratio())              *
+ * P : Play a note with tone() (frequency 0 if invalid),        *
+ *     detuned if required                                      *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLtoneOutput::play(const unsigned char pin, const unsigned char note, const uint16_t ratio){
+  uint16_t frequency = (note < NBNOTES ? pgm_read_word_near(MMLpitchTable<>::frequencies + note) : 0);
+  if(ratio != MMLUNITY)
+    frequency = ((uint32_t)frequency * ratio + (MMLUNITY >> 1)) >> 15;
+  tone(pin, frequency);
+}
+
+/****************************************************************
+ * I : Pin on which the buzzer is plugged                       *
+ * P : Stop the tone                                            *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLtoneOutput::mute(const unsigned char pin){
+  noTone(pin);
+}
+
+//output used by the melodies until another one is set (see MMLtone::setOutput())
+extern MMLtoneOutput MMLdefaultOutput;
+
+#ifdef __AVR__
+/****************************************************************
+ * Timer2 settings of each note, computed at compile time :     *
+ *    compare value in the low byte, clock select bits (CS2x)   *
+ *    in the high byte                                          *
+ * (Matches : compare matches per period of the wave, 2 when    *
+ *  the output is toggled, 1 in fast PWM mode)                  *
+ ****************************************************************/
+template<unsigned char Matches>
+struct MMLtimer2Setting{
+  //prescaler of each clock select value (1 to 7)
+  static constexpr unsigned int prescaler(const unsigned char cs){
+    return (cs == 1 ? 1 : cs == 2 ? 8 : cs == 3 ? 32 : cs == 4 ? 64 : cs == 5 ? 128 : cs == 6 ? 256 : 1024);
+  }
+
+  //compare value giving the frequency of a note (CTC mode : f = F_CPU / (2 * N * (OCR2A + 1)), fast PWM : F_CPU / (N * (OCR2A + 1)))
+  static constexpr double compare(const unsigned char note, const unsigned char cs){
+    return F_CPU / ((double)Matches * prescaler(cs) * MMLpitch::octave(note / 12) * MMLpitch::semitone(note % 12)) - 0.5;
+  }
+
+  //smallest prescaler for which the compare value fits in 8 bits (the lowest notes are clamped)
+  static constexpr uint16_t setting(const unsigned char note, const unsigned char cs = 1){
+    return (cs < 7 && compare(note, cs) >= 256.0 ? setting(note, cs + 1)
+          : compare(note, cs) >= 256.0 ? (uint16_t)((cs << 8) | 255)
+          : (uint16_t)((cs << 8) | (unsigned char)compare(note, cs)));
+  }
+};
+
+template<unsigned char Matches = 2, class Sequence = MMLmakeSequence<NBNOTES>::type>
+struct MMLtimer2Table;
+
+template<unsigned char Matches, unsigned int... I>
+struct MMLtimer2Table<Matches, MMLsequence<I...> >{
+  static constexpr uint16_t settings[NBNOTES] PROGMEM = {MMLtimer2Setting<Matches>::setting(I)...};
+};
+
+template<unsigned char Matches, unsigned int... I>
+constexpr uint16_t MMLtimer2Table<Matches, MMLsequence<I...> >::settings[NBNOTES] PROGMEM;
+
+/****************************************************************
+ * Square wave toggled by timer2 on OC2A (D11 on Uno and Nano), *
+ *    without tone() : a note change is four register writes   *
+ ****************************************************************/
+class MMLtimer2Output : public MMLoutput
+{
+  public:
+      void begin(const unsigned char pin);
+      inline void play(const unsigned char pin, const unsigned char note, const uint16_t ratio);
+      inline void mute(const unsigned char pin);
+};
+
+/****************************************************************
+ * I : Compare value of a note (OCR2A)                          *
+ *     Ratio of the detune (see MMLpitch::ratio())              *
+ * O : Compare value of the detuned note (at most 255)          *
+ *     (the period is divided by the ratio)                     *
+ ****************************************************************/
+inline unsigned char MMLtimer2Detune(const unsigned char compare, const uint16_t ratio){
+  const uint32_t period = (((uint32_t)(compare + 1) << 15) + (ratio >> 1)) / ratio;
+  return (period > 256 ? 255 : period ? period - 1 : 0);
+}
+
+/****************************************************************
+ * I : Pin on which the buzzer is plugged (OC2A)                *
+ *     Index of the note (see pitches.h)                        *
+ *     Ratio of the detune (see MMLpitch::ratio())              *
+ * P : Toggle OC2A at the frequency of the note (CTC mode)      *
+ *     or mute it if the note is invalid                        *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLtimer2Output::play(const unsigned char pin, const unsigned char note, const uint16_t ratio){
+  if(note >= NBNOTES)
+  {
+    this->mute(pin);
+    return;
+  }
+
+  const uint16_t setting = pgm_read_word_near(MMLtimer2Table<>::settings + note);
+
+  //restart the count, so that a lower compare value is not missed
+  OCR2A = (ratio != MMLUNITY ? MMLtimer2Detune(setting & 0xFF, ratio) : setting & 0xFF);
+  TCNT2 = 0;
+  TCCR2A = (1 << COM2A0) | (1 << WGM21);
+  TCCR2B = setting >> 8;
+}
+
+/****************************************************************
+ * I : Pin on which the buzzer is plugged (OC2A)                *
+ * P : Disconnect OC2A from the timer (back to low) and stop it *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLtimer2Output::mute(const unsigned char pin){
+  (void)pin;
+  TCCR2A = 0;
+  TCCR2B = 0;
+}
+
+/****************************************************************
+ * Square wave of variable duty cycle, generated by timer2 in   *
+ *    fast PWM mode on OC2B (D3 on Uno and Nano) : the volume   *
+ *    sets the duty cycle (50 % at full volume)                 *
+ ****************************************************************/
+class MMLpwmOutput : public MMLoutput
+{
+  private:
+      unsigned char   m_top;                //compare value of the note played (OCR2A)
+      unsigned char   m_level;              //volume (0 to 255)
+
+      //compare value of the duty cycle ((OCR2A + 1) * volume / 512)
+      inline unsigned char duty() const{
+        return (unsigned char)(((uint16_t)(this->m_top + 1) * this->m_level) >> 9);
+      }
+
+  public:
+      MMLpwmOutput()
+      :m_top(0), m_level(0xFF)
+      {}
+
+      void begin(const unsigned char pin);
+      inline void play(const unsigned char pin, const unsigned char note, const uint16_t ratio);
+      inline void mute(const unsigned char pin);
+      inline void volume(const unsigned char pin, const unsigned char level);
+};
+
+/****************************************************************
+ * I : Pin on which the buzzer is plugged (OC2B)                *
+ *     Index of the note (see pitches.h)                        *
+ *     Ratio of the detune (see MMLpitch::ratio())              *
+ * P : Generate the note on OC2B (fast PWM, TOP = OCR2A),       *
+ *     or mute it if the note is invalid                        *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLpwmOutput::play(const unsigned char pin, const unsigned char note, const uint16_t ratio){
+  if(note >= NBNOTES)
+  {
+    this->mute(pin);
+    return;
+  }
+
+  const uint16_t setting = pgm_read_word_near(MMLtimer2Table<1>::settings + note);
+  this->m_top = (ratio != MMLUNITY ? MMLtimer2Detune(setting & 0xFF, ratio) : setting & 0xFF);
+
+  //a silent note keeps OC2B disconnected, as a duty of 0 would still pulse once per period
+  OCR2A = this->m_top;
+  OCR2B = this->duty();
+  TCNT2 = 0;
+  TCCR2A = (this->m_level ? (1 << COM2B1) : 0) | (1 << WGM21) | (1 << WGM20);
+  TCCR2B = (1 << WGM22) | (setting >> 8);
+}
+
+/****************************************************************
+ * I : Pin on which the buzzer is plugged (OC2B)                *
+ * P : Disconnect OC2B from the timer (back to low) and stop it *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLpwmOutput::mute(const unsigned char pin){
+  (void)pin;
+  TCCR2A = 0;
+  TCCR2B = 0;
+}
+
+/****************************************************************
+ * I : Pin on which the buzzer is plugged (OC2B)                *
+ *     Volume (0 to 255)                                        *
+ * P : Change the duty cycle (applied at the end of the period) *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLpwmOutput::volume(const unsigned char pin, const unsigned char level){
+  (void)pin;
+  this->m_level = level;
+  OCR2B = this->duty();
+
+  //only while a note is played
+  if(TCCR2B)
+    TCCR2A = (level ? (1 << COM2B1) : 0) | (1 << WGM21) | (1 << WGM20);
+}
+#endif
+#endif
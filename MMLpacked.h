@@ -0,0 +1,157 @@
+/*
+ * MMLpacked.h
+ * -----------------------------------------------
+ * Packed songs : the events of a song (see MMLEVT_* in MMLtone.h), stored in
+ *    a third of the flash their MML code takes.
+ *
+ * Each token holds one event in 1 to 3 bytes. Most notes fit in a single byte :
+ *    bit 7    : clear-cut
+ *    bits 6-4 : duration code, 0 for the duration in use, 1 for it dotted (as MML, the
+ *               duration in use is kept), 2 to 7 for a whole note down to a 1/32 note
+ *               (MMLRESOLUTION >> (code - 2), which becomes the duration in use)
+ *    bits 3-0 : pitch code, semitones from the previous note + MMLPCK_SAME (-6 to +6),
+ *               or MMLPCK_REST (silent note), or MMLPCK_ABS (pitch in the next byte),
+ *               or MMLPCK_EXT (extended token, whose kind replaces the clear-cut and duration)
+ * Extended tokens hold the commands (their argument in the next byte), and the notes
+ *    whose duration has no code (triplets, double dots...) : their pitch and clear-cut
+ *    in the next byte, their amount of ticks in the following one (which becomes the
+ *    duration in use).
+ * As with MML, the previous pitch and the duration in use are restored at each
+ *    repetition of a section : MMLtone keeps them in place of the octave and duration.
+ *
+ * The decoder reads 3 bytes at most and loops over none of them : each token is decoded
+ *    in a bounded amount of cycles, shorter than the byte loop reading a token of MML code.
+ * Songs are packed on the host by extras/host/pack.cpp, from their MML code.
+ *
+ * Usage :
+ *    const uint8_t melodypacked[] PROGMEM = {0x5B, 0x35, ...};  //printed by pack.cpp
+ *    MMLtone melody = MMLtone(12, melodypacked, sizeof(melodypacked));
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#ifndef MMLPACKED_H_INCLUDED
+#define MMLPACKED_H_INCLUDED
+
+#include <Arduino.h>
+#include "MMLtone.h"
+#include "pitches.h"
+
+//layout of the first byte of a token
+#define MMLPCK_PITCH    0x0F    //pitch code
+#define MMLPCK_DUR      0x70    //duration code
+#define MMLPCK_DSHIFT   4       //position of the duration code (and of the kind of an extended token)
+#define MMLPCK_CUT      0x80    //clear-cut on the last tick
+
+//pitch codes
+#define MMLPCK_SAME     6       //same pitch as the previous note (codes 0 to 12 : -6 to +6 semitones)
+#define MMLPCK_REST     13      //silent note (the previous pitch is kept)
+#define MMLPCK_ABS      14      //pitch (or MMLEVT_PITCH) in the next byte
+#define MMLPCK_EXT      15      //extended token
+
+//duration codes
+#define MMLPCK_STICKY   0       //duration in use
+#define MMLPCK_DOTTED   1       //duration in use, dotted
+#define MMLPCK_WHOLE    2       //whole note (codes 2 to 7 : MMLRESOLUTION >> (code - 2))
+
+//kinds of extended tokens (bits 7-4)
+#define MMLPCK_XTEMPO   0       //tempo change (BPM in the next byte)
+#define MMLPCK_XTEMPOH  1       //tempo change (BPM - 256 in the next byte)
+#define MMLPCK_XLOOP    2       //section beginning (no argument)
+#define MMLPCK_XREPEAT  3       //section end (amount of times in the next byte)
+#define MMLPCK_XNOTE    4       //note (pitch | MMLPCK_CUT, then ticks in the next bytes)
+#define MMLPCK_XENVELOPE 8      //envelope parameter (8 to 11 : @A, @D, @S and @R, value in the next byte)
+
+/****************************************************************
+ * I : PROGMEM address of the packed song                       *
+ *     Size of the packed song (in bytes)                       *
+ *     Index of the token (moved past it, at most to the size)  *
+ *     Previous pitch (updated by the notes)                    *
+ *     Duration in use (in ticks, updated)                      *
+ *     Ticks per whole note                                     *
+ * P : Decode a token, reading 3 bytes at most                  *
+ *     (the bytes past the end of the song are read as 0)       *
+ * O : Event (see MMLEVT_* in MMLtone.h)                        *
+ ****************************************************************/
+inline uint16_t MMLunpack(const uint8_t* packed, const unsigned int size, unsigned int& pos,
+                          unsigned char& pitch, unsigned char& duration, const unsigned char resolution = MMLRESOLUTION) __attribute__((always_inline));
+
+uint16_t MMLunpack(const uint8_t* packed, const unsigned int size, unsigned int& pos,
+                   unsigned char& pitch, unsigned char& duration, const unsigned char resolution){
+  const uint8_t token = pgm_read_byte_near(packed + pos);
+  const uint8_t arg = (pos + 1 < size ? pgm_read_byte_near(packed + pos + 1) : 0);
+  const unsigned char code = token & MMLPCK_PITCH;
+  const unsigned char kind = token >> MMLPCK_DSHIFT;
+  unsigned char note = MMLEVT_PITCH, ticks;
+  uint16_t cut = token & MMLPCK_CUT;
+
+  if(code == MMLPCK_EXT)
+  {
+    //commands, their argument replacing the ticks
+    if(kind != MMLPCK_XNOTE)
+    {
+      pos = (kind == MMLPCK_XLOOP || pos + 2 > size ? pos + 1 : pos + 2);
+      switch(kind){
+        case MMLPCK_XTEMPO:
+            return MMLEVT_TEMPO | ((uint16_t)arg << MMLEVT_TSHIFT);
+
+        case MMLPCK_XTEMPOH:
+            return MMLEVT_TEMPO | ((uint16_t)(arg + 256) << MMLEVT_TSHIFT);
+
+        case MMLPCK_XLOOP:
+            return MMLEVT_LOOP;
+
+        case MMLPCK_XREPEAT:
+            return MMLEVT_REPEAT | ((uint16_t)arg << MMLEVT_TSHIFT);
+
+        case MMLPCK_XENVELOPE + MMLENV_ATTACK:
+        case MMLPCK_XENVELOPE + MMLENV_DECAY:
+        case MMLPCK_XENVELOPE + MMLENV_SUSTAIN:
+        case MMLPCK_XENVELOPE + MMLENV_RELEASE:
+            return (MMLEVT_ENVELOPE + kind - MMLPCK_XENVELOPE) | ((uint16_t)arg << MMLEVT_TSHIFT);
+
+        //unknown kinds are played as T0 (tempo unchanged)
+        default:
+            return MMLEVT_TEMPO;
+      }
+    }
+
+    //note of any duration, which becomes the one in use
+    duration = ticks = (pos + 2 < size ? pgm_read_byte_near(packed + pos + 2) : 0);
+    pos = (pos + 3 < size ? pos + 3 : size);
+    note = arg & ~MMLPCK_CUT;
+    cut = arg & MMLPCK_CUT;
+  }
+  else
+  {
+    //duration code
+    const unsigned char d = kind & (MMLPCK_DUR >> MMLPCK_DSHIFT);
+    if(d >= MMLPCK_WHOLE)
+      duration = resolution >> (d - MMLPCK_WHOLE);
+    ticks = duration;
+    if(d == MMLPCK_DOTTED)
+      ticks = (duration + (duration >> 1) > 0xFF ? 0xFF : duration + (duration >> 1));
+
+    //pitch code
+    if(code == MMLPCK_ABS)
+    {
+      note = arg;
+      pos = (pos + 2 < size ? pos + 2 : size);
+    }
+    else
+    {
+      if(code != MMLPCK_REST)
+        note = pitch + code - MMLPCK_SAME;
+      pos++;
+    }
+  }
+
+  //pitches out of the table are played silent, and do not become the previous one
+  if(note > NOTE_B8)
+    note = MMLEVT_PITCH;
+  else
+    pitch = note;
+  return note | ((uint16_t)ticks << MMLEVT_TSHIFT) | (cut ? MMLEVT_CUT : 0);
+}
+#endif
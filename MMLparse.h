@@ -0,0 +1,242 @@
+/*
+ * MMLparse.h
+ * -----------------------------------------------
+ * Decoder of the tokens of MML code into events (see MMLEVT_* in MMLtone.h),
+ *    shared by MMLtone and MMLstaticTone so that both play a song the same way.
+ *
+ * A token is decoded one character at a time, the event holding the partly decoded token
+ *    in between : MMLtone spreads a token of MML code read from PROGMEM over several ticks
+ *    (see MMLDECODECHARS), and decodes the notes copied from a source in one go, as
+ *    MMLstaticTone does.
+ * The octave and the duration in use are kept by the caller, and the ticks per whole note
+ *    are a parameter (MMLstaticTone may play at another resolution) : once inlined with
+ *    a constant resolution, the duration is turned into ticks with shifts only.
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#ifndef MMLPARSE_H_INCLUDED
+#define MMLPARSE_H_INCLUDED
+
+#include <Arduino.h>
+#include "MMLtone.h"
+#include "pitches.h"
+
+/****************************************************************
+ * I : Step reached in the token being decoded (MMLDEC_*)       *
+ *     Next character of the token ('\0' once it ends)          *
+ *     Event being decoded (0 before the first character)       *
+ *     Octave in use (updated)                                  *
+ *     Duration in use (in ticks, updated)                      *
+ *     Ticks per whole note                                     *
+ * P : Decode one character of the token into the event, so     *
+ *        that the text is never kept. Until the token ends,    *
+ *        the pitch field holds the note (or command) and the   *
+ *        ticks field the duration digits (or the argument,     *
+ *        saturated)                                            *
+ * O : Next step (MMLDEC_READY once the token is decoded)       *
+ ****************************************************************/
+inline unsigned char MMLparse(unsigned char step, const char c, uint16_t& event, unsigned char& octave,
+                              unsigned char& duration, const unsigned char resolution = MMLRESOLUTION) __attribute__((always_inline));
+
+unsigned char MMLparse(unsigned char step, const char c, uint16_t& event, unsigned char& octave,
+                       unsigned char& duration, const unsigned char resolution)
+{
+  unsigned char pitch = event & MMLEVT_PITCH;
+  unsigned int value = event >> MMLEVT_TSHIFT;
+  unsigned char odd, shift, param;
+
+  //each step either takes the character and moves on, or falls through to the next one
+  //  (the end of the token falls through all the steps left)
+  switch(step){
+    ///////////////////////////////////////////////////////////////////////////////
+    //                           NOTE DECODING                                   //
+    ///////////////////////////////////////////////////////////////////////////////
+    case MMLDEC_FIRST:
+        //commands hold their argument in place of the ticks
+        if(c == 'T' || c == 't' || c == ']')
+        {
+          pitch = (c == ']' ? MMLEVT_REPEAT : MMLEVT_TEMPO);
+          step = MMLDEC_ARG;
+          break;
+        }
+        if(c == '[')
+        {
+          pitch = MMLEVT_LOOP;
+          step = MMLDEC_REST;
+          break;
+        }
+        if(c == '@')
+        {
+          step = MMLDEC_PARAM;
+          break;
+        }
+
+        //if octave changes, decode
+        if(isdigit(c))
+        {
+          octave = c - 48; //translate ASCII to number ('0' = 48)
+          step = MMLDEC_LETTER;
+          break;
+        }
+        //fall through
+
+    case MMLDEC_LETTER:
+        //compute the note code (12 semi-tones per octave + place of the note in the octave)
+        //  (octaves are coded starting with A instead of C, the octaves below the table
+        //   wrap above it and are played silent)
+        switch(c){
+          case 'A': case 'a': pitch = (TYP_A + (octave * 12)) & MMLEVT_PITCH; break;
+          case 'B': case 'b': pitch = (TYP_B + (octave * 12)) & MMLEVT_PITCH; break;
+          case 'C': case 'c': pitch = (TYP_C + ((octave - 1) * 12)) & MMLEVT_PITCH; break;
+          case 'D': case 'd': pitch = (TYP_D + ((octave - 1) * 12)) & MMLEVT_PITCH; break;
+          case 'E': case 'e': pitch = (TYP_E + ((octave - 1) * 12)) & MMLEVT_PITCH; break;
+          case 'F': case 'f': pitch = (TYP_F + ((octave - 1) * 12)) & MMLEVT_PITCH; break;
+          case 'G': case 'g': pitch = (TYP_G + ((octave - 1) * 12)) & MMLEVT_PITCH; break;
+          default: break;
+        }
+
+        //the letter is skipped (an empty note ends right away)
+        step = MMLDEC_SHARP;
+        if(c)
+          break;
+        //fall through
+
+    case MMLDEC_SHARP:
+        //decode sharp or flat notes
+        if((c == '#') || (c == '+'))
+        {
+          pitch = (pitch + 1) & MMLEVT_PITCH;
+          step = MMLDEC_FLAT;
+          break;
+        }
+        //fall through
+
+    case MMLDEC_FLAT:
+        if(c == '-')
+        {
+          pitch = (pitch - 1) & MMLEVT_PITCH;
+          step = MMLDEC_DUR1;
+          break;
+        }
+        //fall through
+
+    ///////////////////////////////////////////////////////////////////////////////
+    //                           DURATION DECODING                               //
+    ///////////////////////////////////////////////////////////////////////////////
+    case MMLDEC_DUR1:
+        //the pitch is complete (pitches out of the table are played silent)
+        if(pitch > NOTE_B8)
+          pitch = MMLEVT_PITCH;
+
+        //decode note duration (possible 2 digits)
+        if(isdigit(c))
+        {
+          value = c - 48;
+          step = MMLDEC_DUR2;
+          break;
+        }
+        //fall through
+
+    case MMLDEC_DUR2:
+        if(isdigit(c))
+        {
+          value = (value * 10) + (c - 48);
+          step = MMLDEC_DOT;
+          break;
+        }
+        //fall through
+
+    case MMLDEC_DOT:
+        //if a duration is specified, turn it into ticks (resolution / duration) and keep it
+        //  for the next notes. As the AVR has no divider, the duration is split into
+        //  odd part * 2^shift : the whole note (or the triplet whole note, for an odd part of 3)
+        //  is then shifted right
+        odd = value;
+        if(odd)
+        {
+          shift = 0;
+          while(!(odd & 1))
+          {
+            odd >>= 1;
+            shift++;
+          }
+          odd = (odd == 3 ? resolution / 3 : resolution) >> shift;
+          duration = (odd ? odd : 1);
+        }
+
+        //set the number of ticks
+        value = duration;
+
+        //decode dotted note (duration * 1.5, at most 255 ticks)
+        if(c == '.')
+        {
+          value += (value >> 1);
+          if(value > 0xFF)
+            value = 0xFF;
+          step = MMLDEC_CUT;
+          break;
+        }
+        //fall through
+
+    case MMLDEC_CUT:
+        //if note is to be cut (ends with '/'), set the flag to mute during the last tick
+        if(c == '/')
+          value |= (MMLEVT_CUT >> MMLEVT_TSHIFT);
+        step = MMLDEC_REST;
+        break;
+
+    ///////////////////////////////////////////////////////////////////////////////
+    //                           COMMAND DECODING                                //
+    ///////////////////////////////////////////////////////////////////////////////
+    case MMLDEC_PARAM:
+        //the envelope parameter is named by the letter following the @
+        //  (an unknown parameter is played as T0 : tempo unchanged)
+        param = MMLenvelopeParam(c);
+        pitch = (param == MMLENV_NONE ? MMLEVT_TEMPO : MMLEVT_ENVELOPE + param);
+        step = (param == MMLENV_NONE ? MMLDEC_REST : MMLDEC_ARG);
+        break;
+
+    case MMLDEC_ARG:
+        //saturated to the largest argument an event holds
+        //  (the tempo is clamped to MMLMAXTEMPO, the others to 255)
+        if(isdigit(c))
+        {
+          value = (value * 10) + (c - 48);
+          if(value > (MMLEVT_TICKS | MMLEVT_CUT) >> MMLEVT_TSHIFT)
+            value = (MMLEVT_TICKS | MMLEVT_CUT) >> MMLEVT_TSHIFT;
+          break;
+        }
+        if(value > (pitch == MMLEVT_TEMPO ? MMLMAXTEMPO : 0xFF))
+          value = (pitch == MMLEVT_TEMPO ? MMLMAXTEMPO : 0xFF);
+        step = MMLDEC_REST;
+        break;
+
+    default:
+        break;
+  }
+
+  //pack the event
+  event = pitch | ((uint16_t)value << MMLEVT_TSHIFT);
+  return (c ? step : MMLDEC_READY);
+}
+
+/****************************************************************
+ * I : Token copied from a source (NUL-terminated)              *
+ *     Octave in use (updated)                                  *
+ *     Duration in use (in ticks, updated)                      *
+ *     Ticks per whole note                                     *
+ * P : Decode a whole token                                     *
+ * O : Event (see MMLEVT_* in MMLtone.h)                        *
+ ****************************************************************/
+inline uint16_t MMLdecode(const char* buffer, unsigned char& octave, unsigned char& duration,
+                          const unsigned char resolution = MMLRESOLUTION){
+  unsigned char step = MMLDEC_FIRST;
+  uint16_t event = 0;
+
+  while(step != MMLDEC_READY)
+    step = MMLparse(step, *buffer++, event, octave, duration, resolution);
+  return event;
+}
+#endif
@@ -0,0 +1,113 @@
+/*
+ * MMLplaylist.cpp
+ * -----------------------------------------------
+ * Songs played one after the other by an MMLtone melody (see MMLtone::load()).
+ *
+ * When the last note of a song starts, the melody asks the playlist for the next
+ *    song while it would otherwise fetch the following note (on the second tick
+ *    of the last note), and fetches the first note of the next song instead.
+ * That note is then decoded on the very tick the last note ends : the transition
+ *    is tick-accurate, and costs nothing more than a regular note fetch.
+ *
+ * Songs can be added from loop() while the playlist is being played (the ISR only
+ *    reads the songs already counted). Removing songs requires the melody to be stopped.
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#include "MMLplaylist.h"
+
+/****************************************************************
+ * I : Flag indicating whether to play the songs endlessly      *
+ * P : Builds a new, empty playlist                             *
+ * O : /                                                        *
+ ****************************************************************/
+MMLplaylist::MMLplaylist(const bool loop)
+:m_count(0), m_index(0), isLooping(loop)
+{}
+
+/****************************************************************
+ * I : Song to play after the ones already in the playlist      *
+ * P : Append a song to the playlist                            *
+ * O : true if added, false if the playlist is full             *
+ ****************************************************************/
+bool MMLplaylist::add(const MMLsong& song){
+  unsigned char count = this->m_count;
+  if(count >= MMLPLAYLISTSZ)
+    return false;
+
+  this->m_songs[count] = song;
+
+  //publish the song to the ISR
+  MMLBARRIER();
+  this->m_count = count + 1;
+  return true;
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Remove all the songs (melody stopped)                    *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLplaylist::clear(){
+  this->m_count = 0;
+  this->m_index = 0;
+}
+
+/****************************************************************
+ * I : Flag indicating whether to play the songs endlessly      *
+ * P : Set whether the first song follows the last one          *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLplaylist::setLoop(const bool loop){
+  this->isLooping = loop;
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Rewind the playlist                                      *
+ * O : First song, NULL if the playlist is empty                *
+ ****************************************************************/
+const MMLsong* MMLplaylist::first(){
+  this->m_index = 0;
+  return (this->m_count ? this->m_songs : 0);
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Move to the song following the one being played          *
+ *     (called by the melody at the end of each song)           *
+ * O : Next song, NULL if the playlist is over                  *
+ ****************************************************************/
+const MMLsong* MMLplaylist::next(){
+  unsigned char index = this->m_index + 1;
+
+  if(index >= this->m_count)
+  {
+    if(!this->isLooping || !this->m_count)
+      return 0;
+    index = 0;
+  }
+
+  this->m_index = index;
+  return this->m_songs + index;
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Get the index of the song being played                   *
+ * O : Index of the song                                        *
+ ****************************************************************/
+unsigned char MMLplaylist::current(){
+  return this->m_index;
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Get the amount of songs in the playlist                  *
+ * O : Amount of songs                                          *
+ ****************************************************************/
+unsigned char MMLplaylist::count(){
+  return this->m_count;
+}
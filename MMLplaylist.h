@@ -0,0 +1,64 @@
+#ifndef MMLPLAYLIST_H_INCLUDED
+#define MMLPLAYLIST_H_INCLUDED
+
+#include "MMLsource.h"
+
+#define MMLPLAYLISTSZ 8         //maximum amount of songs in a playlist
+
+//kinds of song
+#define MMLSONG_CODE    0       //MML code stored as PROGMEM
+#define MMLSONG_EVENTS  1       //pre-decoded events (see MMLcompiler.h)
+#define MMLSONG_SOURCE  2       //MML code read from an MMLsource
+#define MMLSONG_PACKED  3       //packed song stored as PROGMEM (see MMLpacked.h)
+
+/****************************************************************
+ * Handle on a song, whatever the way it is stored              *
+ ****************************************************************/
+struct MMLsong{
+  const void*         data;                 //PROGMEM address of the code, events or packed song, or MMLsource
+  unsigned int        size;                 //size of the code or packed song, or amount of events
+  unsigned char       type;                 //kind of song (see MMLSONG_*)
+
+  MMLsong()
+  :data(0), size(0), type(MMLSONG_CODE)
+  {}
+
+  MMLsong(const char* code, const unsigned int siz)
+  :data(code), size(siz), type(MMLSONG_CODE)
+  {}
+
+  MMLsong(const uint16_t* events, const unsigned int count)
+  :data(events), size(count), type(MMLSONG_EVENTS)
+  {}
+
+  MMLsong(const uint8_t* packed, const unsigned int siz)
+  :data(packed), size(siz), type(MMLSONG_PACKED)
+  {}
+
+  MMLsong(MMLsource& source)
+  :data(&source), size(source.size()), type(MMLSONG_SOURCE)
+  {}
+};
+
+/****************************************************************
+ * Songs played one after the other, without any gap           *
+ ****************************************************************/
+class MMLplaylist
+{
+  private:
+      MMLsong         m_songs[MMLPLAYLISTSZ];   //songs to play, in order
+      volatile unsigned char m_count;       //amount of songs in the playlist
+      unsigned char   m_index;              //index of the song being played
+      bool            isLooping;            //flag indicating whether the first song follows the last one
+
+  public:
+      MMLplaylist(const bool loop = false);
+      bool add(const MMLsong& song);
+      void clear();
+      void setLoop(const bool loop);
+      const MMLsong* first();
+      const MMLsong* next();
+      unsigned char current();
+      unsigned char count();
+};
+#endif
@@ -0,0 +1,128 @@
+/*
+ * MMLprofile.cpp
+ * -----------------------------------------------
+ * Profiling counters of the functions called in the timer ISR.
+ *
+ * In the instrumented build (MMLPROFILE defined, see MMLprofile.h), each call to
+ *    MMLtone::onTick() and MMLtone::getNextNote() reads a clock when it starts and when
+ *    it returns, and keeps the minimum, maximum and mean durations, along with a
+ *    histogram of the durations by powers of two. The statistics can be read with
+ *    MMLtone::tickProfile() and MMLtone::fetchProfile(), or printed with dumpProfile()
+ *    (e.g. to Serial). Without MMLPROFILE, nothing is added to the library.
+ *
+ * The clock is pluggable (define MMLPROFILE_CLOCK() before including the library) :
+ * - on AVR, the timer1 counter is read by default. As the timer is cleared when it fires
+ *   the ISR, it does not wrap during the ISR. With a prescaler of 8 at 16 MHz,
+ *   a count lasts 0.5 microsecond (8 CPU cycles).
+ * - on the host, the shim provides the CPU timestamp counter (see extras/host/Arduino.h).
+ * - on any other board, micros() is used.
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#include "MMLprofile.h"
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Builds new, empty statistics                             *
+ * O : /                                                        *
+ ****************************************************************/
+MMLprofile::MMLprofile()
+{
+  this->reset();
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Clear the statistics                                     *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLprofile::reset(){
+  this->m_count = 0;
+  this->m_sum = 0;
+  this->m_min = (MMLcycles)~0;
+  this->m_max = 0;
+  for(unsigned char i = 0 ; i < MMLHISTOSZ ; i++)
+    this->m_histogram[i] = 0;
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Get the amount of calls                                  *
+ * O : Amount of calls                                          *
+ ****************************************************************/
+uint32_t MMLprofile::count(){
+  return this->m_count;
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Get the shortest duration                                *
+ * O : Duration (in clock counts, 0 if no call)                 *
+ ****************************************************************/
+MMLcycles MMLprofile::minimum(){
+  return (this->m_count ? this->m_min : 0);
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Get the longest duration (worst-case latency)            *
+ * O : Duration (in clock counts)                               *
+ ****************************************************************/
+MMLcycles MMLprofile::maximum(){
+  return this->m_max;
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Get the mean duration                                    *
+ * O : Duration (in clock counts, 0 if no call)                 *
+ ****************************************************************/
+MMLcycles MMLprofile::mean(){
+  return (this->m_count ? this->m_sum / this->m_count : 0);
+}
+
+/****************************************************************
+ * I : Index of the bucket (0 to MMLHISTOSZ - 1)                *
+ * P : Get the amount of calls in a duration range :            *
+ *     bucket 0 under 2^MMLHISTOSHIFT counts, bucket i from     *
+ *     2^(MMLHISTOSHIFT + i - 1) to 2^(MMLHISTOSHIFT + i), the  *
+ *     last one holding all the longer calls                    *
+ * O : Amount of calls (saturated at 65535)                     *
+ ****************************************************************/
+uint16_t MMLprofile::histogram(const unsigned char bucket){
+  return (bucket < MMLHISTOSZ ? this->m_histogram[bucket] : 0);
+}
+
+/****************************************************************
+ * I : Output (e.g. Serial)                                     *
+ *     Name of the function profiled                            *
+ * P : Print the statistics (to be called from loop(), the      *
+ *     interrupts are briefly disabled to copy them)            *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLprofile::dump(Print& out, const char* label){
+  //copy the statistics while the ISR can not update them
+  cli();
+  MMLprofile copy = *this;
+  sei();
+
+  out.print(label);
+  out.print(" : ");
+  out.print((unsigned long)copy.count());
+  out.print(" calls, min ");
+  out.print((unsigned long)copy.minimum());
+  out.print(", mean ");
+  out.print((unsigned long)copy.mean());
+  out.print(", max ");
+  out.println((unsigned long)copy.maximum());
+
+  for(unsigned char i = 0 ; i < MMLHISTOSZ ; i++)
+  {
+    out.print(i < MMLHISTOSZ - 1 ? "  < " : "  >= ");
+    out.print((unsigned long)1 << (MMLHISTOSHIFT + (i < MMLHISTOSZ - 1 ? i : i - 1)));
+    out.print(" : ");
+    out.println((unsigned long)copy.histogram(i));
+  }
+}
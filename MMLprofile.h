@@ -0,0 +1,103 @@
+#ifndef MMLPROFILE_H_INCLUDED
+#define MMLPROFILE_H_INCLUDED
+
+#include <Arduino.h>
+
+//uncomment to build the instrumented library (or define MMLPROFILE in the build flags)
+//#define MMLPROFILE
+
+//clock read before and after each call (see MMLprofile.cpp)
+#ifndef MMLPROFILE_CLOCK
+#ifdef __AVR__
+#define MMLPROFILE_CLOCK()  TCNT1     //timer1 counter (cleared at each interrupt in CTC mode)
+#else
+#define MMLPROFILE_CLOCK()  micros()
+#endif
+#endif
+
+#ifdef __AVR__
+typedef uint16_t MMLcycles;           //clock counts
+#else
+typedef uint32_t MMLcycles;
+#endif
+
+#define MMLHISTOSZ    8               //amount of histogram buckets
+#ifndef MMLHISTOSHIFT
+#define MMLHISTOSHIFT 4               //the first bucket counts the calls under 2^MMLHISTOSHIFT clock counts
+#endif
+
+/****************************************************************
+ * Statistics of the durations of a function                    *
+ ****************************************************************/
+class MMLprofile
+{
+  private:
+      uint32_t        m_count;              //amount of calls
+      uint32_t        m_sum;                //sum of the durations (for the mean)
+      MMLcycles       m_min;                //shortest duration
+      MMLcycles       m_max;                //longest duration
+      uint16_t        m_histogram[MMLHISTOSZ];  //amount of calls per duration range (powers of two)
+
+  public:
+      MMLprofile();
+      void reset();
+      uint32_t count();
+      MMLcycles minimum();
+      MMLcycles maximum();
+      MMLcycles mean();
+      uint16_t histogram(const unsigned char bucket);
+      void dump(Print& out, const char* label);
+
+      //declared as inline to keep the instrumentation light
+      inline void add(const MMLcycles elapsed) __attribute__((always_inline));
+};
+
+/****************************************************************
+ * I : Duration of a call (in clock counts)                     *
+ * P : Add a call to the statistics                             *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLprofile::add(const MMLcycles elapsed){
+  this->m_count++;
+  this->m_sum += elapsed;
+  if(elapsed < this->m_min)
+    this->m_min = elapsed;
+  if(elapsed > this->m_max)
+    this->m_max = elapsed;
+
+  //bucket = amount of significant bits above MMLHISTOSHIFT
+  unsigned char bucket = 0;
+  for(MMLcycles e = elapsed >> MMLHISTOSHIFT ; e && bucket < MMLHISTOSZ - 1 ; e >>= 1)
+    bucket++;
+  if(this->m_histogram[bucket] < 0xFFFF)
+    this->m_histogram[bucket]++;
+}
+
+/****************************************************************
+ * Times a function from its construction to its destruction    *
+ * (i.e. until any of the returns of the function)              *
+ ****************************************************************/
+class MMLprobe
+{
+  private:
+      MMLprofile*     m_profile;            //statistics updated
+      MMLcycles       m_start;              //clock when the function started
+
+  public:
+      MMLprobe(MMLprofile& profile)
+      :m_profile(&profile), m_start(MMLPROFILE_CLOCK())
+      {}
+
+      ~MMLprobe(){
+        const MMLcycles elapsed = (MMLcycles)(MMLPROFILE_CLOCK() - this->m_start);
+        this->m_profile->add(elapsed);
+      }
+};
+
+//times the rest of the function in the instrumented build only
+#ifdef MMLPROFILE
+#define MMLPROBE(profile) MMLprobe mmlprobe(profile)
+#else
+#define MMLPROBE(profile)
+#endif
+#endif
@@ -0,0 +1,160 @@
+/*
+ * MMLrepeat.h
+ * -----------------------------------------------
+ * Execution of the events which are not notes (tempo changes, envelope parameters and
+ *    repeated sections), shared by MMLtone and MMLstaticTone so that both play a song the same way.
+ *
+ * The repeated sections are played here : [ pushes the position, octave and duration in use
+ *    on the stack (see MMLrepeats in MMLtone.h), ]n jumps back to them until the section
+ *    has been played n times (twice if n is missing). Sections nested deeper than MMLLOOPDEPTH
+ *    are only counted, and played once.
+ * A source which can only be read forward (see MMLstreamSource) can not jump back :
+ *    its [ and ] are ignored, and every section is played once, instead of the melody
+ *    waiting forever for code the source will never hand over again.
+ * A section which has played no note by its end (e.g. "[ [ ]255 ]255") is played once as well :
+ *    repeating it would only run commands, up to millions of them in a single tick.
+ *    The voices also run at most MMLMAXCOMMANDS commands per tick, holding the note playing
+ *    until the next tick beyond that, so that no song can keep the timer ISR busy for long.
+ * The tempo and the envelope parameters are left to the caller, which holds the tempo and the output.
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#ifndef MMLREPEAT_H_INCLUDED
+#define MMLREPEAT_H_INCLUDED
+
+#include <Arduino.h>
+#include "MMLtone.h"
+
+#ifndef MMLMAXCOMMANDS
+#define MMLMAXCOMMANDS  16      //commands run by a voice in a single tick, the following ones waiting for the next tick
+#endif
+static_assert(MMLMAXCOMMANDS > 0 && MMLMAXCOMMANDS < 0x100, "MMLMAXCOMMANDS must be 1 to 255");
+
+//kinds of events, as left to the caller by MMLexecute()
+#define MMLRUN_NOTE     0       //note to be played
+#define MMLRUN_REPEAT   1       //beginning or end of a repeated section (already played)
+#define MMLRUN_TEMPO    2       //tempo change (the BPM in place of the ticks)
+#define MMLRUN_ENVELOPE 3       //envelope parameter (MMLEVT_ENVELOPE + MMLENV_*, the value in place of the ticks)
+
+/****************************************************************
+ * I : Stack of the repeated sections (updated)                 *
+ *     Index of the token following the [                       *
+ *     Octave in use                                            *
+ *     Duration in use (in ticks)                               *
+ * P : Push the beginning of a repeated section on the stack    *
+ * O : /                                                        *
+ ****************************************************************/
+inline void MMLopenLoop(MMLrepeats& repeats, const unsigned int next, const unsigned char octave, const unsigned char duration){
+  //sections nested too deep are only counted, and played once
+  if(repeats.depth < MMLLOOPDEPTH)
+  {
+    MMLloop* loop = repeats.loops + repeats.depth;
+    loop->pos = next;
+    loop->count = 0;
+    loop->octave = octave;
+    loop->duration = duration;
+    repeats.played &= ~(1 << repeats.depth);
+  }
+  if(repeats.depth < 0xFF)
+    repeats.depth++;
+}
+
+/****************************************************************
+ * I : Stack of the repeated sections (updated)                 *
+ *     Amount of times the section is played (0 for twice)      *
+ *     Index of the next token (updated)                        *
+ *     Octave in use (updated)                                  *
+ *     Duration in use (in ticks, updated)                      *
+ * P : Jump back to the beginning of the innermost section,     *
+ *     or leave it once played enough times (at once if it has  *
+ *     played no note)                                          *
+ * O : /                                                        *
+ ****************************************************************/
+inline void MMLcloseLoop(MMLrepeats& repeats, const unsigned int times, unsigned int& next,
+                         unsigned char& octave, unsigned char& duration){
+  //unmatched end of section
+  if(!repeats.depth)
+    return;
+
+  //section nested too deep
+  if(repeats.depth > MMLLOOPDEPTH)
+  {
+    repeats.depth--;
+    return;
+  }
+
+  //section without any note, played once
+  if(!(repeats.played & (1 << (repeats.depth - 1))))
+  {
+    repeats.depth--;
+    return;
+  }
+
+  //first time the end is reached, set the amount of repetitions
+  MMLloop* loop = repeats.loops + repeats.depth - 1;
+  if(!loop->count)
+    loop->count = (!times ? 2 : times > 0xFF ? 0xFF : times);
+
+  //jump back, with the octave and duration in use at the beginning
+  //  (each repetition plays exactly the same notes)
+  loop->count--;
+  if(loop->count)
+  {
+    next = loop->pos;
+    octave = loop->octave;
+    duration = loop->duration;
+  }
+  else
+    repeats.depth--;
+}
+
+/****************************************************************
+ * I : Event fetched (see MMLEVT_* in MMLtone.h)                *
+ *     Stack of the repeated sections (updated)                 *
+ *     Index of the next token (updated)                        *
+ *     Octave in use (updated)                                  *
+ *     Duration in use (in ticks, updated)                      *
+ *     true if the source can only be read forward (each        *
+ *        section is then played once)                          *
+ * P : Play the repeated sections, mark the sections opened as  *
+ *     playing a note if it is one, and tell the caller what is *
+ *     left to do with the event                                *
+ * O : Kind of event (see MMLRUN_*)                             *
+ ****************************************************************/
+inline unsigned char MMLexecute(const uint16_t event, MMLrepeats& repeats, unsigned int& next,
+                                unsigned char& octave, unsigned char& duration, const bool sequential) __attribute__((always_inline));
+
+unsigned char MMLexecute(const uint16_t event, MMLrepeats& repeats, unsigned int& next,
+                         unsigned char& octave, unsigned char& duration, const bool sequential)
+{
+  //commands hold their argument in place of the ticks
+  switch(event & MMLEVT_PITCH){
+    case MMLEVT_TEMPO:
+        return MMLRUN_TEMPO;
+
+    case MMLEVT_LOOP:
+        if(sequential)
+          return MMLRUN_REPEAT;
+        MMLopenLoop(repeats, next, octave, duration);
+        return MMLRUN_REPEAT;
+
+    case MMLEVT_REPEAT:
+        if(sequential)
+          return MMLRUN_REPEAT;
+        MMLcloseLoop(repeats, event >> MMLEVT_TSHIFT, next, octave, duration);
+        return MMLRUN_REPEAT;
+
+    case MMLEVT_ENVELOPE + MMLENV_ATTACK:
+    case MMLEVT_ENVELOPE + MMLENV_DECAY:
+    case MMLEVT_ENVELOPE + MMLENV_SUSTAIN:
+    case MMLEVT_ENVELOPE + MMLENV_RELEASE:
+        return MMLRUN_ENVELOPE;
+
+    default:
+        repeats.played = 0xFF;
+        return MMLRUN_NOTE;
+  }
+}
+#endif
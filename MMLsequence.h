@@ -0,0 +1,47 @@
+/*
+ * MMLsequence.h
+ * -----------------------------------------------
+ * Compile-time sequence of indexes, used to generate PROGMEM arrays
+ *    element by element with constexpr functions (C++11 has no std::index_sequence,
+ *    and the AVR toolchain has no standard library anyway).
+ *
+ * MMLmakeSequence<N>::type is MMLsequence<0, 1, ..., N-1>.
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#ifndef MMLSEQUENCE_H_INCLUDED
+#define MMLSEQUENCE_H_INCLUDED
+
+/****************************************************************
+ * Compile-time sequence of indexes (0, 1, ..., N-1)            *
+ ****************************************************************/
+template<unsigned int... I>
+struct MMLsequence{
+  typedef MMLsequence type;
+};
+
+template<class A, class B>
+struct MMLconcat;
+
+template<unsigned int... A, unsigned int... B>
+struct MMLconcat<MMLsequence<A...>, MMLsequence<B...> >{
+  typedef MMLsequence<A..., (sizeof...(A) + B)...> type;
+};
+
+template<unsigned int N>
+struct MMLmakeSequence
+:MMLconcat<typename MMLmakeSequence<N / 2>::type, typename MMLmakeSequence<N - N / 2>::type>
+{};
+
+template<>
+struct MMLmakeSequence<0>{
+  typedef MMLsequence<> type;
+};
+
+template<>
+struct MMLmakeSequence<1>{
+  typedef MMLsequence<0> type;
+};
+#endif
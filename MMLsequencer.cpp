@@ -0,0 +1,206 @@
+/*
+ * MMLsequencer.cpp
+ * -----------------------------------------------
+ * Plays several MMLtone melodies (voices) from a single clock tick.
+ *
+ * Instead of calling getNextNote() and onTick() on every voice at every tick,
+ *    the sequencer asks each voice how many quiet ticks are to come (ticks during
+ *    which the voice would only decrement its counter), and only processes a voice
+ *    when one of its note boundaries (fetch, clear-cut, new note) is reached, or while
+ *    it decodes its next note a few characters per tick (see MMLDECODECHARS in MMLtone.h).
+ * In between, a tick only decrements a single countdown, whatever the amount of voices.
+ *
+ * The voices must be started and stopped through the sequencer, so that it
+ *    knows when to wake them up.
+ *
+ * The sequencer can also run tickless : onTimer() is then called by a timer (see MMLtimer.h)
+ *    programmed for the exact tick at which the next voice is due, rather than on every tick.
+ * The voices share the tempo of the first one : onClock() (called at MMLCLOCKHZ) and onTimer()
+ *    follow its T<bpm> commands, while those of the other voices are ignored.
+ * Note that Arduino's tone() can only drive one pin at a time on AVR boards.
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#include "MMLsequencer.h"
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Builds a new sequencer, without any voice                *
+ * O : /                                                        *
+ ****************************************************************/
+MMLsequencer::MMLsequencer()
+:m_voices{0}, m_wait{0}, m_skip{0}, m_nbvoices(0), m_countdown(0), m_span(1), m_elapsed(1)
+{}
+
+/****************************************************************
+ * I : Melody to play along the other voices                    *
+ * P : Add a voice to the sequencer                             *
+ * O : true if added, false if the sequencer is full            *
+ ****************************************************************/
+bool MMLsequencer::add(MMLtone& voice){
+  if(this->m_nbvoices >= MAXVOICES)
+    return false;
+
+  this->m_voices[this->m_nbvoices] = &voice;
+  this->m_wait[this->m_nbvoices] = MMLIDLE;
+  this->m_skip[this->m_nbvoices] = 0;
+  this->m_nbvoices++;
+  return true;
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Set the pins of all the voices as outputs                *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLsequencer::setup(){
+  for(unsigned char i = 0 ; i < this->m_nbvoices ; i++)
+    this->m_voices[i]->setup();
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Start all the voices and have them processed on next tick*
+ * O : /                                                        *
+ ****************************************************************/
+void MMLsequencer::start(){
+  for(unsigned char i = 0 ; i < this->m_nbvoices ; i++)
+  {
+    this->m_voices[i]->start();
+    this->m_wait[i] = 0;
+    this->m_skip[i] = 0;
+  }
+  this->m_countdown = 0;
+  this->m_span = 1;
+}
+
+/****************************************************************/
+/*  I : /                                                       */
+/*  P : When a tick is reached, process the voices due          */
+/*  O : /                                                       */
+/****************************************************************/
+void MMLsequencer::onTick(){
+  //quiet tick for all the voices
+  if(this->m_countdown > 0)
+  {
+    this->m_countdown--;
+    return;
+  }
+
+  this->process();
+}
+
+/****************************************************************/
+/*  I : /                                                       */
+/*  P : Advance the tempo of the first voice by one clock period*/
+/*      and process the tick when due (see MMLtempo.h)          */
+/*  O : /                                                       */
+/****************************************************************/
+void MMLsequencer::onClock(){
+  if(this->m_nbvoices && this->m_voices[0]->clock())
+    this->onTick();
+}
+
+/****************************************************************/
+/*  I : Timer which fired the interrupt                         */
+/*  P : Tickless mode : process the voices due, then program    */
+/*      the timer for the next one                              */
+/*  O : /                                                       */
+/****************************************************************/
+void MMLsequencer::onTimer(MMLtimer& timer){
+  //the ticks skipped since the last interrupt were all quiet
+  //  (unless the voices were restarted in between)
+  if(this->m_countdown >= this->m_elapsed - 1)
+    this->m_countdown -= this->m_elapsed - 1;
+  else
+    this->m_countdown = 0;
+
+  this->onTick();
+
+  //follow the tempo changes of the first voice
+  if(this->m_nbvoices)
+    timer.setTempo(this->m_voices[0]->tempo());
+
+  //wake up on the tick at which the next voice is due
+  //  (or as late as the timer allows)
+  const unsigned char maximum = timer.maxTicks();
+  this->m_elapsed = (this->m_countdown >= maximum ? maximum : this->m_countdown + 1);
+  timer.schedule(this->m_elapsed);
+}
+
+/****************************************************************/
+/*  I : /                                                       */
+/*  P : Process the voices reaching a note boundary on this tick*/
+/*      and compute when the next one will be reached           */
+/*  O : /                                                       */
+/****************************************************************/
+void MMLsequencer::process(){
+  unsigned char next = MMLIDLE;
+
+  for(unsigned char i = 0 ; i < this->m_nbvoices ; i++)
+  {
+    //idle voices are only woken up by start()
+    if(this->m_wait[i] == MMLIDLE)
+      continue;
+
+    //voice still quiet on this tick
+    if(this->m_wait[i] >= this->m_span)
+      this->m_wait[i] -= this->m_span;
+
+    //voice due : catch up with the quiet ticks, then process the tick
+    else
+    {
+      MMLtone* voice = this->m_voices[i];
+      voice->skip(this->m_skip[i]);
+      voice->getNextNote();
+      voice->onTick();
+      this->m_wait[i] = this->m_skip[i] = voice->quietTicks();
+    }
+
+    if(this->m_wait[i] < next)
+      next = this->m_wait[i];
+  }
+
+  //the next processing happens right after the shortest wait
+  this->m_countdown = next;
+  this->m_span = next + 1;
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Stop all the voices                                      *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLsequencer::stop(){
+  for(unsigned char i = 0 ; i < this->m_nbvoices ; i++)
+  {
+    this->m_voices[i]->stop();
+    this->m_wait[i] = MMLIDLE;
+  }
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Rewind all the voices                                    *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLsequencer::reset(){
+  for(unsigned char i = 0 ; i < this->m_nbvoices ; i++)
+    this->m_voices[i]->reset();
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Inform about whether all the voices are finished or not  *
+ * O : Sequencer state                                          *
+ ****************************************************************/
+bool MMLsequencer::finished(){
+  for(unsigned char i = 0 ; i < this->m_nbvoices ; i++)
+  {
+    if(!this->m_voices[i]->finished())
+      return false;
+  }
+  return true;
+}
@@ -0,0 +1,35 @@
+#ifndef MMLSEQUENCER_H_INCLUDED
+#define MMLSEQUENCER_H_INCLUDED
+
+#include "MMLtone.h"
+#include "MMLtimer.h"
+
+#define MAXVOICES 4
+
+class MMLsequencer
+{
+  private:
+      MMLtone*        m_voices[MAXVOICES];  //melodies played simultaneously
+      unsigned char   m_wait[MAXVOICES];    //amount of ticks remaining before each voice is to be processed
+      unsigned char   m_skip[MAXVOICES];    //amount of quiet ticks to apply to each voice when processed
+      unsigned char   m_nbvoices;           //amount of voices in use
+      unsigned char   m_countdown;          //amount of ticks remaining before the next voice is to be processed
+      unsigned char   m_span;               //amount of ticks between the last two processings
+      unsigned char   m_elapsed;            //amount of ticks between the last two timer interrupts (tickless mode)
+
+      void process();
+
+  public:
+      MMLsequencer();
+      bool add(MMLtone& voice);
+      void setup();
+      void start();
+      void onTick();
+      void onClock();
+      void onTimer(MMLtimer& timer);
+      void stop();
+      void reset();
+
+      bool finished();
+};
+#endif
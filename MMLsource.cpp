@@ -0,0 +1,253 @@
+/*
+ * MMLsource.cpp
+ * -----------------------------------------------
+ * Memories from which MMLtone can read its MML code.
+ *
+ * A source hands over one whole note per call to fetch() (the space separating it
+ *    from the next one is read but not copied), instead of MMLtone reading
+ *    the code one byte at a time.
+ * Positions are 16 bits wide, so songs can be up to 65535 bytes long.
+ *
+ * Three sources are provided :
+ * - MMLprogmemSource reads from the flash memory (as MMLtone does by default)
+ * - MMLeepromSource reads from the EEPROM
+ * - MMLstreamSource reads sequentially from any Arduino Stream (Serial, SD card file...).
+ *   It is double-buffered : refill() is called from loop() to fill a free half
+ *   of its buffer, while fetch() reads from the other half in the timer ISR.
+ *   A note is only handed over once it has been entirely received : if the buffer runs dry,
+ *   fetch() reads nothing and the melody holds its current note until the next tick.
+ *   It can only be played forward (the stream has to be rewound with rewind()) :
+ *   sequential() tells MMLtone so, which then plays its repeated sections once.
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#include "MMLsource.h"
+#include <avr/eeprom.h>
+
+#define CHUNKMASK ((2 * MMLCHUNKSZ) - 1)
+
+/****************************************************************
+ * I : PROGMEM address of the MML code                          *
+ *     Size of the code array (sizeof())                        *
+ * P : Builds a new PROGMEM source                              *
+ * O : /                                                        *
+ ****************************************************************/
+MMLprogmemSource::MMLprogmemSource(const char* code, const unsigned int siz)
+:m_code(code), m_size(siz)
+{}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Get the size of the MML code                             *
+ * O : Size (in bytes)                                          *
+ ****************************************************************/
+unsigned int MMLprogmemSource::size(){
+  return this->m_size;
+}
+
+/****************************************************************
+ * I : Index of the first byte of the note                      *
+ *     Buffer receiving the note (max + 1 bytes)                *
+ *     Maximum amount of characters to copy                     *
+ * P : Copy a note from the flash memory, followed by a '\0'    *
+ * O : Amount of bytes read (separator included)                *
+ ****************************************************************/
+unsigned char MMLprogmemSource::fetch(const unsigned int pos, char* buffer, const unsigned char max){
+  unsigned char i = 0;
+  unsigned int p = pos;
+  char c;
+
+  while(p < this->m_size)
+  {
+    c = pgm_read_byte_near(this->m_code + p);
+    if(c == ' ' || c == '\0')
+    {
+      p++;
+      break;
+    }
+    if(i >= max)
+      break;
+    buffer[i++] = c;
+    p++;
+  }
+  buffer[i] = '\0';
+  return p - pos;
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Tell whether the source can only be read forward         *
+ *     (its repeated sections are then played once)             *
+ * O : false, fetch() reads from any position                   *
+ ****************************************************************/
+bool MMLsource::sequential(){
+  return false;
+}
+
+/****************************************************************
+ * I : EEPROM address of the MML code                           *
+ *     Size of the code (in bytes)                              *
+ * P : Builds a new EEPROM source                               *
+ * O : /                                                        *
+ ****************************************************************/
+MMLeepromSource::MMLeepromSource(const unsigned int address, const unsigned int siz)
+:m_address(address), m_size(siz)
+{}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Get the size of the MML code                             *
+ * O : Size (in bytes)                                          *
+ ****************************************************************/
+unsigned int MMLeepromSource::size(){
+  return this->m_size;
+}
+
+/****************************************************************
+ * I : Index of the first byte of the note                      *
+ *     Buffer receiving the note (max + 1 bytes)                *
+ *     Maximum amount of characters to copy                     *
+ * P : Copy a note from the EEPROM, followed by a '\0'          *
+ * O : Amount of bytes read (separator included)                *
+ ****************************************************************/
+unsigned char MMLeepromSource::fetch(const unsigned int pos, char* buffer, const unsigned char max){
+  unsigned char i = 0;
+  unsigned int p = pos;
+  char c;
+
+  while(p < this->m_size)
+  {
+    c = eeprom_read_byte((const uint8_t*)(uintptr_t)(this->m_address + p));
+    if(c == ' ' || c == '\0')
+    {
+      p++;
+      break;
+    }
+    if(i >= max)
+      break;
+    buffer[i++] = c;
+    p++;
+  }
+  buffer[i] = '\0';
+  return p - pos;
+}
+
+/****************************************************************
+ * I : Stream from which the MML code is read                   *
+ *     Size of the code (in bytes)                              *
+ * P : Builds a new stream source                               *
+ * O : /                                                        *
+ ****************************************************************/
+MMLstreamSource::MMLstreamSource(Stream& stream, const unsigned int siz)
+:m_stream(&stream), m_size(siz), m_received(0), m_chunks{0}, m_head(0), m_tail(0)
+{}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Get the size of the MML code                             *
+ * O : Size (in bytes)                                          *
+ ****************************************************************/
+unsigned int MMLstreamSource::size(){
+  return this->m_size;
+}
+
+/****************************************************************
+ * I : Index of the first byte of the note (the stream is read  *
+ *        sequentially, it only tells whether the note reaches  *
+ *        the end of the code)                                  *
+ *     Buffer receiving the note (max + 1 bytes)                *
+ *     Maximum amount of characters to copy                     *
+ * P : Copy a note from the buffer filled by refill(),          *
+ *        followed by a '\0'                                    *
+ * O : Amount of bytes read (0 if the whole note has not been   *
+ *        received yet, nothing is read then)                   *
+ ****************************************************************/
+unsigned char MMLstreamSource::fetch(const unsigned int pos, char* buffer, const unsigned char max){
+  unsigned char i = 0, tail = this->m_tail;
+  bool complete = false;
+  char c;
+
+  while(tail != this->m_head)
+  {
+    MMLBARRIER();
+    c = this->m_chunks[tail & CHUNKMASK];
+    if(c == ' ' || c == '\0')
+    {
+      tail++;
+      complete = true;
+      break;
+    }
+    if(i >= max)
+    {
+      complete = true;
+      break;
+    }
+    buffer[i++] = c;
+    tail++;
+  }
+  buffer[i] = '\0';
+
+  //buffer run dry in the middle of a note : leave it to the next call,
+  //  unless the note ends the code
+  if(!complete && pos + (unsigned char)(tail - this->m_tail) < this->m_size)
+    return 0;
+
+  //release the bytes read to refill()
+  MMLBARRIER();
+  i = tail - this->m_tail;
+  this->m_tail = tail;
+  return i;
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Tell whether the source can only be read forward         *
+ * O : true, the stream can not jump back to a repeated section *
+ ****************************************************************/
+bool MMLstreamSource::sequential(){
+  return true;
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Fill the free halves of the buffer from the stream       *
+ *     (to be called from loop(), never from the ISR)           *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLstreamSource::refill(){
+  //fill a whole half at once, and only once it has been entirely read
+  while((unsigned char)(this->m_head - this->m_tail) <= MMLCHUNKSZ && this->m_received < this->m_size)
+  {
+    unsigned char head = this->m_head;
+    for(unsigned char i = 0 ; i < MMLCHUNKSZ && this->m_received < this->m_size ; i++)
+    {
+      int c = this->m_stream->read();
+      if(c < 0)
+        break;
+
+      this->m_chunks[head & CHUNKMASK] = (char)c;
+      head++;
+      this->m_received++;
+    }
+
+    //publish the bytes written to fetch()
+    if(head == this->m_head)
+      return;
+    MMLBARRIER();
+    this->m_head = head;
+  }
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Empty the buffer to read the code from its beginning     *
+ *     (the stream itself has to be rewound beforehand)         *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLstreamSource::rewind(){
+  this->m_head = 0;
+  this->m_tail = 0;
+  this->m_received = 0;
+}
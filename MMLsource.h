@@ -0,0 +1,89 @@
+#ifndef MMLSOURCE_H_INCLUDED
+#define MMLSOURCE_H_INCLUDED
+
+#include <Arduino.h>
+
+#define MMLCHUNKSZ 16   //size of each half of the stream buffer (power of 2, at most 64)
+
+//compiler barrier : keeps the buffer accesses on their side of the index update
+//  shared between loop() and the ISR (single producer, single consumer)
+#define MMLBARRIER() __asm__ __volatile__("" ::: "memory")
+
+/****************************************************************
+ * Interface of a memory holding MML code                       *
+ ****************************************************************/
+class MMLsource
+{
+  public:
+      virtual unsigned int size() = 0;
+      virtual unsigned char fetch(const unsigned int pos, char* buffer, const unsigned char max) = 0;
+      virtual bool sequential();
+};
+
+/****************************************************************
+ * MML code stored as PROGMEM                                   *
+ ****************************************************************/
+class MMLprogmemSource : public MMLsource
+{
+  private:
+      const char*     m_code;               //PROGMEM address of the entire MML code
+      unsigned int    m_size;               //size (in bytes) of the whole MML code
+
+  public:
+      MMLprogmemSource(const char* code, const unsigned int siz);
+      unsigned int size();
+      unsigned char fetch(const unsigned int pos, char* buffer, const unsigned char max);
+};
+
+/****************************************************************
+ * MML code stored in the EEPROM                                *
+ ****************************************************************/
+class MMLeepromSource : public MMLsource
+{
+  private:
+      unsigned int    m_address;            //EEPROM address of the first byte of the MML code
+      unsigned int    m_size;               //size (in bytes) of the whole MML code
+
+  public:
+      MMLeepromSource(const unsigned int address, const unsigned int siz);
+      unsigned int size();
+      unsigned char fetch(const unsigned int pos, char* buffer, const unsigned char max);
+};
+
+/****************************************************************
+ * MML code read sequentially from a stream (Serial, SD file...)*
+ ****************************************************************/
+class MMLstreamSource : public MMLsource
+{
+  private:
+      Stream*         m_stream;             //stream from which the MML code is read
+      unsigned int    m_size;               //size (in bytes) of the whole MML code
+      unsigned int    m_received;           //amount of bytes already read from the stream
+      char            m_chunks[2 * MMLCHUNKSZ]; //two halves, one filled by refill() while the other is read
+      volatile unsigned char m_head;        //amount of bytes written in the buffer (modulo 256)
+      volatile unsigned char m_tail;        //amount of bytes read from the buffer (modulo 256)
+
+  public:
+      MMLstreamSource(Stream& stream, const unsigned int siz);
+      unsigned int size();
+      unsigned char fetch(const unsigned int pos, char* buffer, const unsigned char max);
+      bool sequential();
+      void refill();
+      void rewind();
+};
+
+/****************************************************************
+ * Sources which can only be read forward, for MMLstaticTone    *
+ *    (which holds its source by value, without virtual calls)  *
+ *    Specialise it for any other Source reading a stream       *
+ ****************************************************************/
+template<class Source>
+struct MMLsequentialSource{
+  static const bool value = false;
+};
+
+template<>
+struct MMLsequentialSource<MMLstreamSource>{
+  static const bool value = true;
+};
+#endif
@@ -0,0 +1,432 @@
+/*
+ * MMLstaticTone.h
+ * -----------------------------------------------
+ * Melody whose pin, source, output and resolution are fixed at compile time.
+ *
+ * MMLtone chooses all of them at run time : the pin is a member, the output is called
+ *    through a virtual function, the memory holding the code is tested on every fetch,
+ *    and the playlists, seek() or load() are built in whether they are used or not.
+ * MMLstaticTone takes them as template parameters instead :
+ * - Pin : pin on which the buzzer is plugged (a constant in every output call)
+ * - Source : MMLprogmemSource (default), MMLeepromSource or any class with the same
+ *   size() and fetch(), or MMLeventSource for the events compiled by MML_COMPILE,
+ *   or MMLpackedSource for a packed song (see MMLpacked.h).
+ *   The source is held by value, and only the code reading that kind of source is built.
+ *   A Source which can only be read forward plays its repeated sections once,
+ *   and has to specialise MMLsequentialSource (see MMLsource.h).
+ * - Output : MMLtoneOutput (default), MMLtimer2Output or any MMLoutput, held by value
+ *   and called without any virtual call, so that the compiler can inline it
+ * - Resolution : ticks per whole note (MMLRESOLUTION by default, see MMLtempo.h).
+ *   The events compiled by MML_COMPILE hold ticks at MMLRESOLUTION, and can only be
+ *   played at that resolution.
+ *
+ * The MML code is played with exactly the same rules as MMLtone (see MMLtone.cpp), its tokens
+ *    being decoded by the same MMLparse() (see MMLparse.h), and its tempo changes and repeated sections
+ *    executed by the same MMLexecute() (see MMLrepeat.h). Only the ISR part is kept :
+ *    no playlist, no seek(), no load() and no profiling, and the melody can not be
+ *    a voice of an MMLsequencer. Its sources copy a whole note at once, which is decoded
+ *    on the second tick of the previous one (MMLDECODECHARS does not apply).
+ *
+ * Usage :
+ *    const char melodycode[] PROGMEM = {"T120 4D4 G2 G8 B8 A8 B8 G2./"};
+ *    MMLstaticTone<12> melody = MMLstaticTone<12>(MMLprogmemSource(melodycode, sizeof(melodycode)));
+ *
+ *    MML_COMPILE(melodyevents, "4D4 G2 G8 B8 A8 B8 G2./");
+ *    MMLstaticTone<11, MMLeventSource, MMLtimer2Output> melody =
+ *        MMLstaticTone<11, MMLeventSource, MMLtimer2Output>(MMLeventSource(melodyevents::events, melodyevents::count));
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#ifndef MMLSTATICTONE_H_INCLUDED
+#define MMLSTATICTONE_H_INCLUDED
+
+#include <Arduino.h>
+#include "MMLtone.h"
+#include "MMLsource.h"
+#include "MMLoutput.h"
+#include "MMLpacked.h"
+#include "MMLparse.h"
+#include "MMLrepeat.h"
+#include "pitches.h"
+
+//RAM allowed for the state of an MMLstaticTone, besides its source and output : fixed amounts, as MMLVOICEBUDGET
+//  (36 bytes on AVR with 4 loops, 56 on 64-bit hosts, i.e. 88 bytes with an MMLprogmemSource and MMLtoneOutput)
+#ifdef __AVR__
+#define MMLSTATICBUDGET (16 + MMLLOOPDEPTH * 5)
+#else
+#define MMLSTATICBUDGET (24 + MMLLOOPDEPTH * 8)
+#endif
+
+/****************************************************************
+ * Pre-decoded events stored as PROGMEM (see MMLcompiler.h)     *
+ ****************************************************************/
+class MMLeventSource
+{
+  private:
+      const uint16_t* m_events;             //PROGMEM address of the pre-decoded events
+      unsigned int    m_count;              //amount of events
+
+  public:
+      MMLeventSource(const uint16_t* events, const unsigned int count)
+      :m_events(events), m_count(count)
+      {}
+
+      unsigned int size(){
+        return this->m_count;
+      }
+
+      uint16_t event(const unsigned int pos){
+        return pgm_read_word_near(this->m_events + pos);
+      }
+};
+
+/****************************************************************
+ * Packed song stored as PROGMEM (see MMLpacked.h)              *
+ ****************************************************************/
+class MMLpackedSource
+{
+  private:
+      const uint8_t*  m_packed;             //PROGMEM address of the packed song
+      unsigned int    m_size;               //size (in bytes) of the packed song
+
+  public:
+      MMLpackedSource(const uint8_t* packed, const unsigned int siz)
+      :m_packed(packed), m_size(siz)
+      {}
+
+      unsigned int size(){
+        return this->m_size;
+      }
+
+      const uint8_t* data(){
+        return this->m_packed;
+      }
+};
+
+template<unsigned char Pin, class Source = MMLprogmemSource, class Output = MMLtoneOutput, unsigned char Resolution = MMLRESOLUTION>
+class MMLstaticTone
+{
+  static_assert(Resolution == 64 || Resolution == 96 || Resolution == 128 || Resolution == 192,
+                "the resolution must be 64, 96, 128 or 192 ticks per whole note");
+
+  private:
+      Source          m_source;             //memory holding the MML code or the events
+      Output          m_output;             //output producing the notes
+      unsigned int    m_next;               //index of the next note in the MML code
+      unsigned int    m_current;            //index of the current note playing in the MML code
+      uint16_t        m_event;              //next note played, decoded when fetched (see MMLEVT_*)
+      unsigned char   m_octave;             //octave in which the notes will be played until updated (previous pitch if packed)
+      unsigned char   m_nbtick;             //amount of ticks remaining to play the note (decrements while playing)
+      unsigned char   m_duration;           //amount of ticks of the notes until updated
+      uint16_t        m_bpm;                //tempo (in beats per minute)
+      uint16_t        m_phase;              //clock calls accumulated towards the next tick
+      bool            isFinished : 1;       //flag indicating whether the last note has been played
+      bool            lastnote : 1;         //flag indicating whether the last note is being played
+      bool            isStarted : 1;        //flag indicating whether the music is to be played or not
+      bool            cut_note : 1;         //flag indicating whether there is a clear-cut in the note
+      bool            isRefreshed : 1;      //flag indicating whether the next note is to be read
+      MMLrepeats      m_repeats;            //stack of the repeated sections being played
+
+      //the overloads taking an MMLeventSource or an MMLpackedSource are chosen at compile time
+      void fetch(MMLeventSource& source);
+      void fetch(MMLpackedSource& source);
+      template<class S> void fetch(S& source);
+      bool command();
+      void setTempo(const unsigned int bpm);
+
+  public:
+      MMLstaticTone(const Source& source, const Output& output = Output());
+      void setup();
+      void start();
+      void onTick();
+      void getNextNote();
+      void stop();
+      void reset();
+
+      //declared as inline to avoid a function call in the clock ISR
+      inline bool clock() __attribute__((always_inline));
+
+      bool started();
+      bool finished();
+      bool last();
+};
+
+/****************************************************************
+ * I : Source providing the MML code or the events              *
+ *     Output producing the notes                               *
+ * P : Builds a new melody                                      *
+ * O : /                                                        *
+ ****************************************************************/
+template<unsigned char Pin, class Source, class Output, unsigned char Resolution>
+MMLstaticTone<Pin, Source, Output, Resolution>::MMLstaticTone(const Source& source, const Output& output)
+:m_source(source), m_output(output), m_next(0), m_current(0), m_event(0),
+  m_octave(0), m_nbtick(0), m_duration(Resolution / MMLDEFDURATION), m_bpm(MMLDEFTEMPO), m_phase(0),
+  isFinished(false), lastnote(false), isStarted(false), cut_note(false), isRefreshed(false), m_repeats{}
+{
+  static_assert(sizeof(MMLstaticTone) - sizeof(Source) - sizeof(Output) <= MMLSTATICBUDGET,
+                "MMLstaticTone exceeds the RAM budget of a melody (see MMLSTATICBUDGET)");
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Set the pin up through the output                        *
+ * O : /                                                        *
+ ****************************************************************/
+template<unsigned char Pin, class Source, class Output, unsigned char Resolution>
+void MMLstaticTone<Pin, Source, Output, Resolution>::setup(){
+  this->m_output.Output::begin(Pin);
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Set the started flag                                     *
+ * O : /                                                        *
+ ****************************************************************/
+template<unsigned char Pin, class Source, class Output, unsigned char Resolution>
+void MMLstaticTone<Pin, Source, Output, Resolution>::start(){
+  if(!this->isFinished)
+    this->isStarted = true;
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : When a tick is reached, decode a note and play it        *
+ *     (same steps as MMLtone::onTick())                        *
+ * O : /                                                        *
+ ****************************************************************/
+template<unsigned char Pin, class Source, class Output, unsigned char Resolution>
+void MMLstaticTone<Pin, Source, Output, Resolution>::onTick(){
+  if(!this->isStarted)
+    return;
+
+  //if note is to be cut, mute during the last tick
+  if(this->cut_note && this->m_nbtick == 1)
+    this->m_output.Output::mute(Pin);
+
+  //getNextNote() has already fetched the next note during this tick, clear the flag
+  this->isRefreshed = false;
+
+  //check if note is still to be played
+  if(this->m_nbtick > 0)
+  {
+    this->m_nbtick--;
+    return;
+  }
+
+  //next note not received yet from its source : fetch it again, on each tick until it comes
+  if(this->m_current == this->m_next && this->m_next < this->m_source.Source::size())
+  {
+    this->isRefreshed = true;
+    this->getNextNote();
+    this->isRefreshed = false;
+  }
+
+  //if last note has been played, set the finished flag (only once the whole song has been read)
+  if(this->m_current == this->m_next)
+  {
+    this->isFinished = (this->m_next >= this->m_source.Source::size());
+    return;
+  }
+
+  //execute the commands preceding the note, and fetch the token following each of them
+  //  (at most MMLMAXCOMMANDS per tick, the note playing being held until the next one)
+  unsigned char commands = 0;
+  while(this->command())
+  {
+    this->isRefreshed = true;
+    this->getNextNote();
+    this->isRefreshed = false;
+    if(this->m_current == this->m_next)
+    {
+      this->isFinished = (this->m_next >= this->m_source.Source::size());
+      return;
+    }
+    if(++commands >= MMLMAXCOMMANDS)
+      return;
+  }
+
+  this->lastnote = (this->m_next >= this->m_source.Source::size());
+
+  //unpack the note (decoded when fetched), play it and set the flag to fetch the next note on 2nd tick
+  this->m_nbtick = (this->m_event & MMLEVT_TICKS) >> MMLEVT_TSHIFT;
+  this->cut_note = (this->m_event & MMLEVT_CUT);
+  this->m_output.Output::play(Pin, this->m_event & MMLEVT_PITCH, MMLUNITY);
+  this->isRefreshed = true;
+  this->m_nbtick--;
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Fetches the next note on the 2nd tick of each note       *
+ * O : /                                                        *
+ ****************************************************************/
+template<unsigned char Pin, class Source, class Output, unsigned char Resolution>
+void MMLstaticTone<Pin, Source, Output, Resolution>::getNextNote(){
+  if(this->m_next > 0 && !this->isRefreshed)
+    return;
+
+  this->m_current = this->m_next;
+  if(this->m_next >= this->m_source.Source::size())
+    return;
+
+  this->fetch(this->m_source);
+}
+
+/****************************************************************
+ * I : Source of pre-decoded events                             *
+ * P : Read the next event                                      *
+ * O : /                                                        *
+ ****************************************************************/
+template<unsigned char Pin, class Source, class Output, unsigned char Resolution>
+void MMLstaticTone<Pin, Source, Output, Resolution>::fetch(MMLeventSource& source){
+  static_assert(Resolution == MMLRESOLUTION, "pre-decoded events can only be played at MMLRESOLUTION");
+
+  this->m_event = source.event(this->m_next);
+  this->m_next++;
+}
+
+/****************************************************************
+ * I : Source of a packed song                                  *
+ * P : Decode the next token into an event                      *
+ * O : /                                                        *
+ ****************************************************************/
+template<unsigned char Pin, class Source, class Output, unsigned char Resolution>
+void MMLstaticTone<Pin, Source, Output, Resolution>::fetch(MMLpackedSource& source){
+  static_assert(Resolution == MMLRESOLUTION, "packed songs can only be played at MMLRESOLUTION");
+
+  this->m_event = MMLunpack(source.data(), source.size(), this->m_next, this->m_octave, this->m_duration, Resolution);
+}
+
+/****************************************************************
+ * I : Source of MML code                                       *
+ * P : Copy the next note and decode it into an event           *
+ *     (nothing is read if it has not been received yet)        *
+ * O : /                                                        *
+ ****************************************************************/
+template<unsigned char Pin, class Source, class Output, unsigned char Resolution>
+template<class S>
+void MMLstaticTone<Pin, Source, Output, Resolution>::fetch(S& source){
+  char buffer[NOTBUFSZ];
+  const unsigned char length = source.S::fetch(this->m_next, buffer, NOTBUFSZ - 1);
+  if(!length)
+    return;
+  this->m_next += length;
+  this->m_event = MMLdecode(buffer, this->m_octave, this->m_duration, Resolution);
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Executes the command held in the event, if any           *
+ *     (same rules as MMLtone::command(), see MMLrepeat.h)      *
+ * O : true if a command has been executed                      *
+ ****************************************************************/
+template<unsigned char Pin, class Source, class Output, unsigned char Resolution>
+bool MMLstaticTone<Pin, Source, Output, Resolution>::command(){
+  switch(MMLexecute(this->m_event, this->m_repeats, this->m_next, this->m_octave, this->m_duration,
+                    MMLsequentialSource<Source>::value)){
+    case MMLRUN_NOTE:
+        return false;
+
+    case MMLRUN_TEMPO:
+        this->setTempo(this->m_event >> MMLEVT_TSHIFT);
+        return true;
+
+    case MMLRUN_ENVELOPE:
+        this->m_output.Output::envelope(Pin, (this->m_event & MMLEVT_PITCH) - MMLEVT_ENVELOPE, this->m_event >> MMLEVT_TSHIFT);
+        return true;
+
+    default:
+        return true;
+  }
+}
+
+/****************************************************************
+ * I : Tempo (in beats per minute, 0 leaves it unchanged)       *
+ * P : Change the tempo at which clock() generates the ticks    *
+ * O : /                                                        *
+ ****************************************************************/
+template<unsigned char Pin, class Source, class Output, unsigned char Resolution>
+void MMLstaticTone<Pin, Source, Output, Resolution>::setTempo(const unsigned int bpm){
+  if(bpm)
+    this->m_bpm = (bpm > MMLMAXTEMPO ? MMLMAXTEMPO : bpm);
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Advance the tempo by one clock period                    *
+ *     (to be called at MMLCLOCKHZ, see MMLtempo.h)             *
+ * O : true if getNextNote() and onTick() are due               *
+ ****************************************************************/
+template<unsigned char Pin, class Source, class Output, unsigned char Resolution>
+bool MMLstaticTone<Pin, Source, Output, Resolution>::clock(){
+  this->m_phase += this->m_bpm;
+  if(this->m_phase < MMLCLOCKHZ * 60UL / (Resolution / 4))
+    return false;
+
+  this->m_phase -= MMLCLOCKHZ * 60UL / (Resolution / 4);
+  return true;
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Mute the output and unset the started flag               *
+ * O : /                                                        *
+ ****************************************************************/
+template<unsigned char Pin, class Source, class Output, unsigned char Resolution>
+void MMLstaticTone<Pin, Source, Output, Resolution>::stop(){
+  this->m_output.Output::mute(Pin);
+  this->isStarted = false;
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Rewind the melody to its first note, at MMLDEFTEMPO      *
+ * O : /                                                        *
+ ****************************************************************/
+template<unsigned char Pin, class Source, class Output, unsigned char Resolution>
+void MMLstaticTone<Pin, Source, Output, Resolution>::reset(){
+  this->m_bpm = MMLDEFTEMPO;
+  this->lastnote = false;
+  this->isFinished = false;
+  this->m_next = 0;
+  this->m_current = 0;
+  this->m_repeats.depth = 0;
+  this->m_octave = 0;
+  this->m_duration = Resolution / MMLDEFDURATION;
+  this->m_nbtick = 0;
+  this->cut_note = false;
+  this->isRefreshed = false;
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Inform about whether the melody is started or not        *
+ * O : Melody state                                             *
+ ****************************************************************/
+template<unsigned char Pin, class Source, class Output, unsigned char Resolution>
+bool MMLstaticTone<Pin, Source, Output, Resolution>::started(){
+  return this->isStarted;
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Inform about whether the melody is finished or not       *
+ * O : Melody state                                             *
+ ****************************************************************/
+template<unsigned char Pin, class Source, class Output, unsigned char Resolution>
+bool MMLstaticTone<Pin, Source, Output, Resolution>::finished(){
+  return this->isFinished;
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Informs about whether the last tone is reached or not    *
+ * O : Melody state                                             *
+ ****************************************************************/
+template<unsigned char Pin, class Source, class Output, unsigned char Resolution>
+bool MMLstaticTone<Pin, Source, Output, Resolution>::last(){
+  return this->lastnote;
+}
+#endif
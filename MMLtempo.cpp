@@ -0,0 +1,54 @@
+/*
+ * MMLtempo.cpp
+ * -----------------------------------------------
+ * Runtime tempo of a melody.
+ *
+ * Rather than setting the tempo through the timer frequency, the timer fires at a
+ *    fixed rate (MMLCLOCKHZ, 1 kHz by default) and calls clock(), which tells when
+ *    a tick (1/MMLRESOLUTION note) is due.
+ * The BPM is added to a phase accumulator on each call, and a tick is due each time
+ *    the accumulator reaches MMLCLOCKDIV (3750 at 1 kHz and 64 ticks per whole note).
+ *    The remainder is carried over to the next tick, so that any tempo is played
+ *    exactly, without drift and without reprogramming the timer.
+ * With a finer resolution, the ticks come faster (up to about 400 per second at 192
+ *    and 511 BPM), and MMLCLOCKHZ should be raised to keep their jitter low.
+ * The jitter of a tick is at most one clock period (1 ms at 1 kHz).
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#include "MMLtempo.h"
+
+/****************************************************************
+ * I : Tempo (in beats per minute)                              *
+ * P : Builds a new tempo                                       *
+ * O : /                                                        *
+ ****************************************************************/
+MMLtempo::MMLtempo(const unsigned int bpm)
+:m_bpm(0), m_phase(0)
+{
+  this->set(bpm);
+}
+
+/****************************************************************
+ * I : Tempo (in beats per minute, 1 to MMLMAXTEMPO)            *
+ * P : Change the tempo, starting with the next clock period    *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLtempo::set(const unsigned int bpm){
+  //a tempo of 0 would never tick again, keep the current one
+  if(!bpm)
+    return;
+
+  this->m_bpm = (bpm > MMLMAXTEMPO ? MMLMAXTEMPO : bpm);
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Get the current tempo                                    *
+ * O : Tempo (in beats per minute)                              *
+ ****************************************************************/
+unsigned int MMLtempo::bpm(){
+  return this->m_bpm;
+}
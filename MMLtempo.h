@@ -0,0 +1,55 @@
+#ifndef MMLTEMPO_H_INCLUDED
+#define MMLTEMPO_H_INCLUDED
+
+#include <stdint.h>
+
+#ifndef MMLRESOLUTION
+#define MMLRESOLUTION 64                        //ticks per whole note (64, 96, 128 or 192)
+#endif
+#define MMLTICKSPERBEAT (MMLRESOLUTION / 4)     //ticks per quarter note
+
+#define MMLCLOCKHZ    1000                      //frequency at which clock() is called (in Hz)
+#define MMLCLOCKDIV   (MMLCLOCKHZ * 60UL / MMLTICKSPERBEAT)  //clock calls per tick at 1 BPM
+#define MMLMAXTEMPO   511                       //highest tempo (in beats per minute)
+#define MMLDEFTEMPO   120                       //tempo of a melody until set otherwise (in beats per minute)
+
+//durations are turned into ticks with shifts only (see MMLtone::decode()),
+//  and a whole note must fit in the 8 bits tick counter
+static_assert(MMLRESOLUTION == 64 || MMLRESOLUTION == 96 || MMLRESOLUTION == 128 || MMLRESOLUTION == 192,
+              "MMLRESOLUTION must be 64, 96, 128 or 192 ticks per whole note");
+
+/****************************************************************
+ * Tempo of a melody, turning a fixed-rate clock into ticks     *
+ ****************************************************************/
+class MMLtempo
+{
+  private:
+      uint16_t        m_bpm;                //tempo (in beats per minute)
+      uint16_t        m_phase;              //clock calls accumulated towards the next tick (over MMLCLOCKDIV)
+
+  public:
+      MMLtempo(const unsigned int bpm = MMLDEFTEMPO);
+      void set(const unsigned int bpm);
+      unsigned int bpm();
+
+      //declared as inline to avoid a function call in the clock ISR
+      inline bool clock() __attribute__((always_inline));
+};
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Advance the tempo by one clock period                    *
+ *     (to be called MMLCLOCKHZ times per second)               *
+ * O : true if a tick is due, false otherwise                   *
+ ****************************************************************/
+bool MMLtempo::clock(){
+  //a tick lasts MMLCLOCKDIV / BPM clock periods :
+  //  accumulate the BPM and carry the remainder over (no division, no drift)
+  this->m_phase += this->m_bpm;
+  if(this->m_phase < MMLCLOCKDIV)
+    return false;
+
+  this->m_phase -= MMLCLOCKDIV;
+  return true;
+}
+#endif
@@ -0,0 +1,88 @@
+/*
+ * MMLtimer.cpp
+ * -----------------------------------------------
+ * Timers used for tickless playback (see MMLsequencer::onTimer()).
+ *
+ * Instead of firing an interrupt on every tick, the timer is programmed
+ *    for the exact moment of the next note event (fetch, clear-cut, new note).
+ *    On long notes, this divides the amount of interrupts by an order of magnitude,
+ *    and the MCU can sleep in between.
+ *
+ * MMLtimer1 uses the AVR timer1 with a prescaler of 256, so that up to about
+ *    a second fits in its 16 bits compare register.
+ * The length of a tick rarely is a whole amount of timer counts
+ *    (e.g. 1953.125 counts at 120 BPM with 16 MHz), so the fractional part is
+ *    accumulated from one interrupt to the next to avoid any drift.
+ * Tempos too slow for a tick to fit in 16 bits (below 4 BPM at 16 MHz) are clamped
+ *    to the slowest one which does (see MMLtimerPeriod in MMLtimer.h).
+ * The tempo follows the T<bpm> commands of the first voice of the sequencer
+ *    (see MMLsequencer::onTimer()).
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#include "MMLtimer.h"
+
+#ifdef __AVR__
+/****************************************************************
+ * I : Tempo (in beats per minute)                              *
+ * P : Builds a new timer1 handler                              *
+ * O : /                                                        *
+ ****************************************************************/
+MMLtimer1::MMLtimer1(const unsigned int bpm)
+{
+  this->setTempo(bpm);
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Set timer1 up to fire its first interrupt after one tick *
+ *     (to be called with interrupts disabled)                  *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLtimer1::begin(){
+  //clear TCCR1 and reset counter value
+  TCCR1A = 0;
+  TCCR1B = 0;
+  TCNT1  = 0;
+
+  //turn on CTC mode with a 256 prescaler
+  // + enable timer compare interrupt
+  this->m_period.reset();
+  this->schedule(1);
+  TCCR1B |= (1 << WGM12);
+  TCCR1B |= (1 << CS12) | (0 << CS11) | (0 << CS10);
+  TIMSK1 |= (1 << OCIE1A);
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Get the maximum amount of ticks between two interrupts   *
+ * O : Maximum amount of ticks                                  *
+ ****************************************************************/
+unsigned char MMLtimer1::maxTicks(){
+  return this->m_period.maxTicks();
+}
+
+/****************************************************************
+ * I : Amount of ticks until the next interrupt (1 to maxTicks) *
+ * P : Program the compare register for the next interrupt      *
+ *     (to be called from the timer ISR)                        *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLtimer1::schedule(const unsigned char ticks){
+  //the counter is cleared on compare match, the new value is used right away
+  OCR1A = this->m_period.counts(ticks) - 1;
+}
+
+/****************************************************************
+ * I : Tempo (in beats per minute, clamped to the lowest one    *
+ *        fitting the compare register, 4 BPM at 16 MHz)        *
+ * P : Compute the timer counts per tick for a new tempo        *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLtimer1::setTempo(const unsigned int bpm){
+  this->m_period.setTempo(bpm);
+}
+#endif
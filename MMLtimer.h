@@ -0,0 +1,163 @@
+#ifndef MMLTIMER_H_INCLUDED
+#define MMLTIMER_H_INCLUDED
+
+#include <Arduino.h>
+#include "MMLtempo.h"
+
+/****************************************************************
+ * Interface of a timer firing an interrupt a given amount of   *
+ *    clock ticks (1/MMLRESOLUTION notes) after the previous one*
+ *    (maxTicks() is at least 1, at any tempo it accepts)       *
+ ****************************************************************/
+class MMLtimer
+{
+  public:
+      virtual unsigned char maxTicks() = 0;
+      virtual void schedule(const unsigned char ticks) = 0;
+      virtual void setTempo(const unsigned int bpm) = 0;
+};
+
+/****************************************************************
+ * Length of a tick in counts of a 16 bits timer, Counts being  *
+ *    the amount of timer counts per minute over 4              *
+ *    (the fractional counts are carried from one period        *
+ *    to the next)                                              *
+ ****************************************************************/
+template<unsigned long Counts>
+class MMLtimerPeriod
+{
+  private:
+      uint16_t        m_quotient;           //whole amount of timer counts per tick
+      uint16_t        m_remainder;          //fractional amount of timer counts per tick (over m_divisor)
+      uint16_t        m_divisor;            //divisor of the fractional counts
+      uint16_t        m_error;              //fractional counts accumulated so far (over m_divisor)
+      uint16_t        m_bpm;                //tempo (in beats per minute)
+      unsigned char   m_max;                //maximum amount of ticks in a period
+
+  public:
+      //lowest tempo at which a tick fits in 16 bits, slower ones are clamped to it
+      static const unsigned int minTempo = Counts / (0xFFFFUL * MMLTICKSPERBEAT) + 1;
+
+      MMLtimerPeriod()
+      :m_error(0), m_bpm(0)
+      {}
+
+      void reset();
+      unsigned char maxTicks();
+      uint16_t counts(const unsigned char ticks);
+      void setTempo(const unsigned int bpm);
+      unsigned int tempo();
+};
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Drop the fractional counts accumulated so far            *
+ * O : /                                                        *
+ ****************************************************************/
+template<unsigned long Counts>
+void MMLtimerPeriod<Counts>::reset(){
+  this->m_error = 0;
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Get the maximum amount of ticks in a period              *
+ * O : Maximum amount of ticks (at least 1)                     *
+ ****************************************************************/
+template<unsigned long Counts>
+unsigned char MMLtimerPeriod<Counts>::maxTicks(){
+  return this->m_max;
+}
+
+/****************************************************************
+ * I : Amount of ticks of the period (1 to maxTicks())          *
+ * P : Add the counts of all the ticks at once, carrying the    *
+ *        fractional part over (a subtraction for a single tick,*
+ *        one division for several, to be called from the ISR)  *
+ * O : Amount of timer counts of the period                     *
+ ****************************************************************/
+template<unsigned long Counts>
+uint16_t MMLtimerPeriod<Counts>::counts(const unsigned char ticks){
+  //ticks * (m_quotient + 1) fits in 16 bits (see maxTicks())
+  uint16_t counts = ticks * this->m_quotient;
+  uint32_t error = this->m_error + (uint32_t)ticks * this->m_remainder;
+
+  //whole counts made of the fractional parts (at most one for a single tick)
+  if(error >= 2UL * this->m_divisor)
+  {
+    const uint16_t carried = error / this->m_divisor;
+    counts += carried;
+    error -= (uint32_t)carried * this->m_divisor;
+  }
+  else if(error >= this->m_divisor)
+  {
+    counts++;
+    error -= this->m_divisor;
+  }
+
+  this->m_error = error;
+  return counts;
+}
+
+/****************************************************************
+ * I : Tempo (in beats per minute, clamped to minTempo)         *
+ * P : Compute the timer counts per tick for a new tempo        *
+ *     (only when it changes, the divisions are not free)       *
+ * O : /                                                        *
+ ****************************************************************/
+template<unsigned long Counts>
+void MMLtimerPeriod<Counts>::setTempo(const unsigned int bpm){
+  if(!bpm)
+    return;
+
+  //below minTempo, a tick would not fit in 16 bits (and no tick in a period)
+  unsigned int tempo = bpm;
+  if(tempo < minTempo)
+    tempo = minTempo;
+  if(tempo == this->m_bpm)
+    return;
+
+  this->m_bpm = tempo;
+  this->m_divisor = tempo * MMLTICKSPERBEAT;
+  this->m_quotient = Counts / this->m_divisor;
+  this->m_remainder = Counts % this->m_divisor;
+  this->m_error = 0;
+
+  //the period holds 16 bits
+  unsigned int maximum = 0xFFFF / (this->m_quotient + 1);
+  this->m_max = (maximum > 0xFF ? 0xFF : maximum);
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Get the tempo of the ticks                               *
+ * O : Tempo (in beats per minute, 0 if never set)              *
+ ****************************************************************/
+template<unsigned long Counts>
+unsigned int MMLtimerPeriod<Counts>::tempo(){
+  return this->m_bpm;
+}
+
+#ifdef __AVR__
+//timer counts per tick = F_CPU / (256 * ticks per second)
+//                      = (F_CPU * 15 / 64) / (BPM * MMLTICKSPERBEAT)
+#define MMLTIMER1COUNTS ((unsigned long)F_CPU * 15 / 64)
+
+/****************************************************************
+ * AVR timer1 in CTC mode (prescaler 256), calling              *
+ *    TIMER1_COMPA_vect                                         *
+ ****************************************************************/
+class MMLtimer1 : public MMLtimer
+{
+  private:
+      MMLtimerPeriod<MMLTIMER1COUNTS> m_period; //timer counts per tick
+
+  public:
+      MMLtimer1(const unsigned int bpm);
+      void begin();
+      unsigned char maxTicks();
+      void schedule(const unsigned char ticks);
+      void setTempo(const unsigned int bpm);
+};
+#endif
+#endif
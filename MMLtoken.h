@@ -0,0 +1,246 @@
+/*
+ * MMLtoken.h
+ * -----------------------------------------------
+ * Compile-time view of an MML token (note or command), shared by the
+ *    compiler (see MMLcompiler.h) and the validator (see MMLvalidator.h).
+ *
+ * Each member function evaluates one rule of MMLtone::decode() or
+ *    MMLtone::command(), as C++11 constexpr functions (a single return each).
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#ifndef MMLTOKEN_H_INCLUDED
+#define MMLTOKEN_H_INCLUDED
+
+#include <Arduino.h>
+#include "MMLtone.h"
+#include "pitches.h"
+
+//reasons for which a token is rejected by the validator
+#define MMLERR_NONE       0     //valid token
+#define MMLERR_EMPTY      1     //empty token (consecutive spaces, trailing space)
+#define MMLERR_LENGTH     2     //token longer than NOTBUFSZ - 1 characters (truncated when fetched)
+#define MMLERR_LETTER     3     //unknown note letter (played as the lowest note)
+#define MMLERR_SYNTAX     4     //unexpected character
+#define MMLERR_DURATION   5     //duration not dividing MMLRESOLUTION into at least 2 ticks, or dotted beyond 255 ticks
+#define MMLERR_OCTAVE     6     //note without any octave set before
+#define MMLERR_NODURATION 7     //note without any duration set before (played as a quarter note)
+#define MMLERR_PITCH      8     //pitch out of the table (below A0 or above B8, played silent)
+#define MMLERR_TEMPO      9     //tempo missing or out of range (1 to MMLMAXTEMPO)
+#define MMLERR_REPEAT     10    //repeat count out of range (1 to 255), section end without beginning, or section without any note (played once)
+#define MMLERR_NESTING    11    //section nested deeper than MMLLOOPDEPTH (played once)
+#define MMLERR_UNCLOSED   12    //section beginning without end
+#define MMLERR_ENVELOPE   13    //unknown envelope parameter (@A, @D, @S or @R), or value missing or above 255
+#define MMLNBERR          14
+
+/****************************************************************
+ * Note token, as fetched in the buffer by getNextNote()        *
+ ****************************************************************/
+struct MMLtoken{
+  const char*   code;   //MML code
+  unsigned int  pos;    //index of the first character of the token
+  unsigned int  len;    //amount of characters in the token
+
+  constexpr MMLtoken(const char* c, const unsigned int p, const unsigned int l)
+  :code(c), pos(p), len(l)
+  {}
+
+  //character at index i, '\0' past the end of the token (as in the buffer)
+  constexpr char at(const unsigned int i) const{
+    return (i < len ? code[pos + i] : '\0');
+  }
+
+  static constexpr bool digit(const char c){
+    return (c >= '0' && c <= '9');
+  }
+
+  //index of the note letter (after the facultative octave)
+  constexpr unsigned int letter() const{
+    return (digit(at(0)) ? 1 : 0);
+  }
+
+  //index right after the facultative sharp
+  constexpr unsigned int sharpEnd() const{
+    return (at(letter() + 1) == '#' || at(letter() + 1) == '+' ? letter() + 2 : letter() + 1);
+  }
+
+  //index of the duration (after the facultative sharp and flat)
+  constexpr unsigned int durationIndex() const{
+    return (at(sharpEnd()) == '-' ? sharpEnd() + 1 : sharpEnd());
+  }
+
+  //index right after the duration digits
+  constexpr unsigned int durationEnd() const{
+    return durationIndex() + (digit(at(durationIndex())) ? (digit(at(durationIndex() + 1)) ? 2 : 1) : 0);
+  }
+
+  //whether the token is a tempo change (T<bpm>) rather than a note
+  constexpr bool tempo() const{
+    return (at(0) == 'T' || at(0) == 't');
+  }
+
+  //whether the token sets an envelope parameter (@A, @D, @S or @R followed by the value)
+  constexpr bool envelope() const{
+    return (at(0) == '@');
+  }
+
+  //whether the token is a command (tempo change, section beginning or end, envelope) rather than a note
+  constexpr bool command() const{
+    return (tempo() || at(0) == '[' || at(0) == ']' || envelope());
+  }
+
+  //value given to an envelope parameter (at most 255)
+  constexpr unsigned int level() const{
+    return (number(2) > 0xFF ? 0xFF : number(2));
+  }
+
+  //amount of times a section is played (0 for twice)
+  constexpr unsigned int times() const{
+    return (number(1) > 0xFF ? 0xFF : number(1));
+  }
+
+  //value of the digits starting at index i (same rules as MMLtone::command())
+  constexpr unsigned int number(const unsigned int i, const unsigned int value = 0) const{
+    return (digit(at(i)) ? number(i + 1, value * 10 + (at(i) - '0')) : value);
+  }
+
+  //tempo set by the token (0 leaves the tempo unchanged)
+  constexpr unsigned int bpm() const{
+    return (number(1) > MMLMAXTEMPO ? MMLMAXTEMPO : number(1));
+  }
+
+  //amount of digits starting at index i
+  constexpr unsigned int digits(const unsigned int i) const{
+    return (digit(at(i)) ? 1 + digits(i + 1) : 0);
+  }
+
+  //index right after the facultative dot
+  constexpr unsigned int dotEnd() const{
+    return durationEnd() + (at(durationEnd()) == '.' ? 1 : 0);
+  }
+
+  //index right after the facultative clear-cut (end of a well-formed note)
+  constexpr unsigned int noteEnd() const{
+    return dotEnd() + (at(dotEnd()) == '/' ? 1 : 0);
+  }
+
+  static constexpr bool note(const char l){
+    return ((l >= 'A' && l <= 'G') || (l >= 'a' && l <= 'g'));
+  }
+
+  //whether a duration lasts a whole amount of ticks, two at least (the first one fetches the next note)
+  static constexpr bool playable(const unsigned char d){
+    return (d && MMLRESOLUTION % d == 0 && MMLRESOLUTION / d >= 2);
+  }
+
+  //whether a note of t ticks is dotted beyond the 8 bits tick counter
+  constexpr bool overflow(const unsigned char t) const{
+    return (at(durationEnd()) == '.' && t + (t >> 1) > 0xFF);
+  }
+
+  //error in a tempo change (see MMLERR_* above)
+  constexpr unsigned char lintTempo() const{
+    return (digits(1) + 1 != len ? MMLERR_SYNTAX
+          : !digits(1) || digits(1) > 3 || !number(1) || number(1) > MMLMAXTEMPO ? MMLERR_TEMPO
+          : MMLERR_NONE);
+  }
+
+  //error in a section end (see MMLERR_* above)
+  constexpr unsigned char lintRepeat() const{
+    return (digits(1) + 1 != len ? MMLERR_SYNTAX
+          : digits(1) > 3 || (digits(1) && (!number(1) || number(1) > 0xFF)) ? MMLERR_REPEAT
+          : MMLERR_NONE);
+  }
+
+  //error in an envelope parameter (see MMLERR_* above)
+  constexpr unsigned char lintEnvelope() const{
+    return (MMLenvelopeParam(at(1)) == MMLENV_NONE ? MMLERR_ENVELOPE
+          : digits(2) + 2 != len ? MMLERR_SYNTAX
+          : !digits(2) || digits(2) > 3 || number(2) > 0xFF ? MMLERR_ENVELOPE
+          : MMLERR_NONE);
+  }
+
+  //error in a note, regardless of the notes before (see MMLERR_* above)
+  constexpr unsigned char lintNote() const{
+    return (!note(at(letter())) ? MMLERR_LETTER
+          : noteEnd() != len ? MMLERR_SYNTAX
+          : durationEnd() > durationIndex() && !playable(value()) ? MMLERR_DURATION
+          : MMLERR_NONE);
+  }
+
+  //octave in use after this token
+  constexpr unsigned char octave(const unsigned char current) const{
+    return (digit(at(0)) ? at(0) - '0' : current);
+  }
+
+  //duration (in ticks) in use after this token (a duration of 0 keeps the current one)
+  constexpr unsigned char duration(const unsigned char current) const{
+    return (command() || !value() ? current : length(value()));
+  }
+
+  //amount of ticks of a duration, with the shifts of MMLtone::decode() (duration = odd * 2^shift)
+  static constexpr unsigned char length(const unsigned char d, const unsigned char shift = 0){
+    return (!(d & 1) ? length(d >> 1, shift + 1)
+          : ((d == 3 ? MMLRESOLUTION / 3 : MMLRESOLUTION) >> shift) ? (unsigned char)((d == 3 ? MMLRESOLUTION / 3 : MMLRESOLUTION) >> shift)
+          : 1);
+  }
+
+  //duration written in the token (0 if none)
+  constexpr unsigned char value() const{
+    return (durationEnd() == durationIndex() ? 0
+          : durationEnd() == durationIndex() + 1 ? at(durationIndex()) - '0'
+          : (at(durationIndex()) - '0') * 10 + (at(durationIndex() + 1) - '0'));
+  }
+
+  //index of the note (see pitches.h), with the same wrap-arounds as MMLtone::decode()
+  constexpr unsigned char pitch(const unsigned char oct) const{
+    return accidental(base(at(letter()), oct));
+  }
+
+  static constexpr unsigned char base(const char l, const unsigned char oct){
+    return (l == 'A' || l == 'a' ? (unsigned char)(TYP_A + oct * 12)
+          : l == 'B' || l == 'b' ? (unsigned char)(TYP_B + oct * 12)
+          : l == 'C' || l == 'c' ? (unsigned char)(TYP_C + (oct - 1) * 12)
+          : l == 'D' || l == 'd' ? (unsigned char)(TYP_D + (oct - 1) * 12)
+          : l == 'E' || l == 'e' ? (unsigned char)(TYP_E + (oct - 1) * 12)
+          : l == 'F' || l == 'f' ? (unsigned char)(TYP_F + (oct - 1) * 12)
+          : l == 'G' || l == 'g' ? (unsigned char)(TYP_G + (oct - 1) * 12)
+          : 0);
+  }
+
+  constexpr unsigned char accidental(const unsigned char note) const{
+    return flat(sharpEnd() > letter() + 1 ? (unsigned char)(note + 1) : note);
+  }
+
+  constexpr unsigned char flat(const unsigned char note) const{
+    return (durationIndex() > sharpEnd() ? (unsigned char)(note - 1) : note);
+  }
+
+  //amount of ticks, dotted durations included (at most 255)
+  constexpr unsigned char ticks(const unsigned char t) const{
+    return (overflow(t) ? 0xFF : at(durationEnd()) == '.' ? (unsigned char)(t + (t >> 1)) : t);
+  }
+
+  constexpr bool cut() const{
+    return (at(durationEnd() + (at(durationEnd()) == '.' ? 1 : 0)) == '/');
+  }
+
+  //pre-decoded event, given the octave and duration in use before the token
+  constexpr uint16_t event(const unsigned char oct, const unsigned char dur) const{
+    return (tempo() ? (uint16_t)(MMLEVT_TEMPO | (bpm() << MMLEVT_TSHIFT))
+         : at(0) == '[' ? (uint16_t)MMLEVT_LOOP
+         : at(0) == ']' ? (uint16_t)(MMLEVT_REPEAT | (times() << MMLEVT_TSHIFT))
+         : envelope() ? (MMLenvelopeParam(at(1)) == MMLENV_NONE ? (uint16_t)MMLEVT_TEMPO
+                        : (uint16_t)((MMLEVT_ENVELOPE + MMLenvelopeParam(at(1))) | (level() << MMLEVT_TSHIFT)))
+         : noteEvent(oct, dur));
+  }
+
+  constexpr uint16_t noteEvent(const unsigned char oct, const unsigned char dur) const{
+    return (pitch(octave(oct)) > NOTE_B8 ? MMLEVT_PITCH : pitch(octave(oct)))
+         | ((uint16_t)ticks(duration(dur)) << MMLEVT_TSHIFT)
+         | (cut() ? MMLEVT_CUT : 0);
+  }
+};
+#endif
@@ -2,23 +2,30 @@
  * MMLtone.cpp
  * -----------------------------------------------
  * Library used to handle MML (Music Macro Language) coding.
- * This library is used to play (with the Arduino instruction Tone()) music
- *    which has been coded as a string.
+ * This library is used to play (with the Arduino instruction Tone(), or any other
+ *    output, see MMLoutput.h) music which has been coded as a string.
  * 
- * The string containing the MML code must be stored as PROGMEM in order to save RAM.
+ * The string containing the MML code must be stored as PROGMEM in order to save RAM,
+ *    or read from an MMLsource (EEPROM, stream, ...). Songs can be up to 65535 bytes long.
  * Also, the library has been designed to be as lightweight as possible in terms of RAM and execution time.
- * There is no floating point calculations and no array used, and all the frequencies are precomputed.
+ * There is no floating point calculations, and all the frequencies are precomputed at compile time
+ *    in a PROGMEM table (see REFPITCH in pitches.h to change the tuning).
  * The cost in terms of stack could be improved, though.
  * 
  * The library provides two main methods :
- * - getNextNote() reads the next note to be played and keeps it in a buffer
- * - onTick() decodes the note read by getNextNote() and plays it.
+ * - getNextNote() reads the next note to be played and decodes it into a 16-bit event
+ * - onTick() unpacks the event decoded by getNextNote() and plays it.
  * 
  * Both methods are to be put in a portion of code executed with a timer, or enclosed with a millis() mechanism
- * The timer interval has to be set as the length of a 1/64 note. This is reffered to as a clock tick.
- * While getNextNote() belongs in the clock tick code portion, it will be executed only on the second tick of
- * each note in order to flatten the execution time. This is why, as the tick is set to a 1/64 note, the minimum
- * length of a note can only be 1/32.
+ * The timer interval has to be set as the length of a 1/MMLRESOLUTION note (1/64 by default, see MMLtempo.h).
+ * This is reffered to as a clock tick.
+ * While getNextNote() belongs in the clock tick code portion, it starts decoding the next note only on the second tick of
+ * each note in order to flatten the execution time. This is why the minimum length of a note is two ticks
+ * (1/32 with 64 ticks per whole note, 1/96 with 192).
+ * The MML code is decoded one character at a time, MMLDECODECHARS characters per tick (half a token by default) :
+ *    the next note is ready by the end of the current one, and no tick reads more than that from the song,
+ *    except the first tick of a song and the notes following a command (T, [, ], @), decoded on the tick
+ *    they start. Pre-decoded events, packed songs and MMLsource read a whole note at once.
  * 
  * Notes are to be separated with a space character and are presented as such :
  *    4D16#./
@@ -30,11 +37,53 @@
  *  - A number after a note indicates its value/duration. Here a 16 means it's an eighth note (1/16 whole note,
  *    or 4 ticks).
  *    The same duration will be used in all the notes until a new one is specified. This is facultative
- *    once set on first note.
- *    This has to be a power of two and cannot exceed 32
+ *    once set on first note (notes are quarter notes until then).
+ *    This has to divide MMLRESOLUTION into at least two ticks : a power of two up to 32 by default.
+ *    With MMLRESOLUTION set to 96 or 192, triplets are available (3, 6, 12, 24, 48, and 96 at 192 :
+ *    e.g. three C12 last a quarter note), and so are 1/64 notes at 192.
  *  - A # or a + means it's a sharp note (a semitone higher), and a - means it's a flat note (a semitone lower)
  *  - A . means it's a dotted note. It adds another half of the note’s duration to it.
  *  - A / induces a clear-cut bewteen two notes. This is to make sure a separation is heard between notes
+ *
+ * A section enclosed in [ and ]n is played n times (twice if n is omitted, up to 255), e.g. :
+ *    4C8 [ D8 E8 [ F8 ]3 ]2 G4
+ *    The brackets are tokens of their own, and sections can be nested up to MMLLOOPDEPTH levels
+ *    (deeper ones are played once). Playback jumps back to the beginning of the section,
+ *    with the octave and duration in use at that moment, so the phrase is only stored once.
+ *    A section holding no note is played once, and at most MMLMAXCOMMANDS commands are run
+ *    per tick (see MMLrepeat.h), so that no song keeps the timer ISR busy for long.
+ *    MMLstreamSource can only be read forward : its repeated sections are played once.
+ *
+ * A token starting with a T changes the tempo (e.g. T140 for 140 BPM, up to MMLMAXTEMPO) from the next note on.
+ *    It is only taken into account when the ticks are generated with clock() (see MMLtempo.h),
+ *    which is to be called at a fixed rate (MMLCLOCKHZ) instead of on every tick :
+ *      if(melody.clock()){ melody.getNextNote(); melody.onTick(); }
+ *    The tempo can also be changed at any time with setTempo(), until the song is rewound :
+ *    reset(), play() through MMLcontrol and the seeks start the song at MMLDEFTEMPO, until its first T.
+ *
+ * A token starting with an @ sets a parameter of the volume envelope (@A attack, @D decay,
+ *    @S sustain, @R release, followed by a value up to 255, e.g. @S160), handed over to the output.
+ *    Only an MMLenvelope output takes them into account (see MMLenvelope.h), the others ignore them.
+ *
+ * The notes can be transposed with setTranspose() (clamped to A0 - B8) and detuned with setDetune()
+ *    (up to a semitone, each voice holding its own detune), without changing the song.
+ *
+ * Playback can resume from any tick or bar with seekToTick() and seekToBar() : the song is walked
+ *    from its beginning, or from the last checkpoint of an MMLindex before that tick (see MMLindex.h).
+ *
+ * The MML code can also be compiled at build time into pre-decoded events (see MMLcompiler.h).
+ *    The notes are then only unpacked during the clock ticks, which avoids all the text decoding.
+ *    Songs can also be packed on the host into 1 to 3 bytes per note or command (see MMLpacked.h),
+ *    a third of their MML code, and are then decoded in a bounded amount of reads.
+ *
+ * Each voice only keeps that event, its settings, indexes and loops stack in RAM (49 bytes on AVR) :
+ *    the song itself stays in PROGMEM (or in its source), and the flags share a single byte.
+ *    MMLVOICEBUDGET caps that size (a fixed amount, raised on purpose only), and is checked at compile time.
+ *    As the flags share a byte, a melody played in an ISR is only to be modified
+ *    from that ISR, or through MMLcontrol (see MMLcontrol.h).
+ *
+ * When built with MMLPROFILE, the durations of onTick() and getNextNote() are measured
+ *    on every call (see MMLprofile.h).
  *  
  * -----------------------------------------------
  *  Author : Gilles Henrard
@@ -42,9 +91,16 @@
  */
 
 #include "MMLtone.h"
+#include "MMLpacked.h"
+#include "MMLparse.h"
+#include "MMLrepeat.h"
 #include "pitches.h"
 #include <Arduino.h>
 
+#ifndef MMLPROFILE
+static_assert(sizeof(MMLtone) <= MMLVOICEBUDGET, "MMLtone exceeds the RAM budget of a voice (see MMLVOICEBUDGET)");
+#endif
+
 /****************************************************************
  * I : Pin on which the buzzer is plugged                       *
  *     Pointer to the MML string                                *
@@ -52,15 +108,67 @@
  * P : Builds a new MMLtone module                              *
  * O : /                                                        *
  ****************************************************************/
-MMLtone::MMLtone(const unsigned char Pin, const char* code, const unsigned char siz)
-:isFinished(false), lastnote(false), isStarted(false), cut_note(false), isRefreshed(false),
-  m_octave(0), m_nbtick(0), m_duration(0), m_next(0), m_current(0), m_buffer{0}
+MMLtone::MMLtone(const unsigned char Pin, const char* code, const unsigned int siz)
+:m_octave(0), m_nbtick(0), m_duration(MMLDEFTICKS),
+  isFinished(false), lastnote(false), isStarted(false), cut_note(false), isRefreshed(false), isCompiled(false), isSourced(false), isPacked(false),
+  m_transpose(0), m_decode(MMLDEC_READY), m_event(0), m_ratio(MMLUNITY), m_next(0), m_current(0), m_repeats{}, m_playlist(0), m_output(&MMLdefaultOutput)
 {
   this->pin = Pin;
   this->m_code = code;
   this->m_size = siz;
 }
 
+/****************************************************************
+ * I : Pin on which the buzzer is plugged                       *
+ *     Pointer to the pre-decoded events (see MMLcompiler.h)    *
+ *     Amount of events                                         *
+ * P : Builds a new MMLtone module playing pre-decoded events   *
+ * O : /                                                        *
+ ****************************************************************/
+MMLtone::MMLtone(const unsigned char Pin, const uint16_t* events, const unsigned int count)
+:m_octave(0), m_nbtick(0), m_duration(MMLDEFTICKS),
+  isFinished(false), lastnote(false), isStarted(false), cut_note(false), isRefreshed(false), isCompiled(true), isSourced(false), isPacked(false),
+  m_transpose(0), m_decode(MMLDEC_READY), m_event(0), m_ratio(MMLUNITY), m_next(0), m_current(0), m_repeats{}, m_playlist(0), m_output(&MMLdefaultOutput)
+{
+  this->pin = Pin;
+  this->m_events = events;
+  this->m_size = count;
+}
+
+/****************************************************************
+ * I : Pin on which the buzzer is plugged                       *
+ *     Pointer to the packed song (see MMLpacked.h)             *
+ *     Size of the packed song (sizeof())                       *
+ * P : Builds a new MMLtone module playing a packed song        *
+ * O : /                                                        *
+ ****************************************************************/
+MMLtone::MMLtone(const unsigned char Pin, const uint8_t* packed, const unsigned int siz)
+:m_octave(0), m_nbtick(0), m_duration(MMLDEFTICKS),
+  isFinished(false), lastnote(false), isStarted(false), cut_note(false), isRefreshed(false), isCompiled(false), isSourced(false), isPacked(true),
+  m_transpose(0), m_decode(MMLDEC_READY), m_event(0), m_ratio(MMLUNITY), m_next(0), m_current(0), m_repeats{}, m_playlist(0), m_output(&MMLdefaultOutput)
+{
+  this->pin = Pin;
+  this->m_packed = packed;
+  this->m_size = siz;
+}
+
+/****************************************************************
+ * I : Pin on which the buzzer is plugged                       *
+ *     Source providing the MML code (see MMLsource.h)          *
+ * P : Builds a new MMLtone module reading its code from a      *
+ *     source (EEPROM, stream, ...)                             *
+ * O : /                                                        *
+ ****************************************************************/
+MMLtone::MMLtone(const unsigned char Pin, MMLsource& source)
+:m_octave(0), m_nbtick(0), m_duration(MMLDEFTICKS),
+  isFinished(false), lastnote(false), isStarted(false), cut_note(false), isRefreshed(false), isCompiled(false), isSourced(true), isPacked(false),
+  m_transpose(0), m_decode(MMLDEC_READY), m_event(0), m_ratio(MMLUNITY), m_next(0), m_current(0), m_repeats{}, m_playlist(0), m_output(&MMLdefaultOutput)
+{
+  this->pin = Pin;
+  this->m_source = &source;
+  this->m_size = source.size();
+}
+
 /****************************************************************
  * I : /                                                        *
  * P : Destroys the current MMLtone module                      *
@@ -71,11 +179,11 @@ MMLtone::~MMLtone()
 
 /****************************************************************
  * I : /                                                        *
- * P : Set the pin as an output                                 *
+ * P : Set the pin up through the output                        *
  * O : /                                                        *
  ****************************************************************/
 void MMLtone::setup(){
-  pinMode((int)this->pin, OUTPUT);
+  this->m_output->begin(this->pin);
 }
 
 /****************************************************************
@@ -95,17 +203,18 @@ void MMLtone::start(){
 /****************************************************************/
 int MMLtone::onTick()
 {
+    MMLPROBE(this->m_tickProfile);
+
     //if music is supposed to be stopped, exit
     if(!this->isStarted)
       return 0;
 
     //if note is to be cut, noTone() during the last tick
     if(this->cut_note && this->m_nbtick == 1)
-      noTone(this->pin);
+      this->m_output->mute(this->pin);
 
-    //on first tick, clear the flag indicating next note is to be decoded
-    if(this->m_nbtick >= (64 / this->m_duration) - 1)
-      this->isRefreshed = false;
+    //getNextNote() has already fetched the next note during this tick, clear the flag
+    this->isRefreshed = false;
 
     //check if note is still to be played
     if(this->m_nbtick > 0)
@@ -114,165 +223,229 @@ int MMLtone::onTick()
         return 0;
     }
 
+    //finish decoding the next note if the current one was too short to spread it
+    //  over its ticks (see MMLDECODECHARS)
+    if(this->m_decode)
+      this->read(MMLDEC_ALL);
+
+    //next note not received yet from its source (see MMLstreamSource) : fetch it again,
+    //  on each tick until it comes (the note playing is held)
+    if(this->m_current == this->m_next && this->m_next < this->m_size)
+      this->advance(MMLDEC_ALL);
+
     //if last note has been played, set the finished flag
+    //  (only once the whole song has been read)
     if(this->m_current == this->m_next){
-      this->isFinished = true;
+      this->isFinished = (this->m_next >= this->m_size);
       return 0;
     }
 
-    //if last note has been reached, set the last note flag
-    if(this->m_next >= this->m_size)
-      this->lastnote = true;
-
-    //clear the clear-cut flag
-    this->cut_note = false;
-
-    ///////////////////////////////////////////////////////////////////////////////
-    //                           NOTE DECODING                                   //
-    ///////////////////////////////////////////////////////////////////////////////
-
-    //place the note code iterator + declare all variables
-    char* it = this->m_buffer;
-    unsigned char duration = 0, note = 0;
-
-    //if octave changes, decode
-    if(isdigit(*it))
+    //execute the commands preceding the note (tempo changes, repeated sections),
+    //  and decode the token following each of them right away
+    //  (at most MMLMAXCOMMANDS per tick, the note playing being held until the next one)
+    unsigned char commands = 0;
+    while(this->command())
     {
-        this->m_octave = *it - 48; //translate ASCII to number ('0' = 48)
-        it++;
+      this->advance(MMLDEC_ALL);
+      if(this->m_current == this->m_next){
+        this->isFinished = (this->m_next >= this->m_size);
+        return 0;
+      }
+      if(++commands >= MMLMAXCOMMANDS)
+        return 0;
     }
 
-    //compute the note code (12 semi-tones per octave + place of the note in the octave)
-    //  (octaves are coded starting with A instead of C)
-    switch(*it){
-      case 'A':
-      case 'a':
-          note = TYP_A + (this->m_octave * 12);
-          break;
-          
-      case 'B':
-      case 'b':
-          note = TYP_B + (this->m_octave * 12);
-          break;
-          
-      case 'C':
-      case 'c':
-          note = TYP_C + ((this->m_octave - 1) * 12);
-          break;
-          
-      case 'D':
-      case 'd':
-          note = TYP_D + ((this->m_octave - 1) * 12);
-          break;
-          
-      case 'E':
-      case 'e':
-          note = TYP_E + ((this->m_octave - 1) * 12);
-          break;
-          
-      case 'F':
-      case 'f':
-          note = TYP_F + ((this->m_octave - 1) * 12);
-          break;
-          
-      case 'G':
-      case 'g':
-          note = TYP_G + ((this->m_octave - 1) * 12);
-          break;
+    //if last note has been reached, set the last note flag
+    //  (cleared by the first note of the next song of a playlist)
+    this->lastnote = (this->m_next >= this->m_size);
 
-      default:
-          break;
-    }
-    it++;
+    //unpack the note (decoded when fetched)
+    this->m_nbtick = (this->m_event & MMLEVT_TICKS) >> MMLEVT_TSHIFT;
+    this->cut_note = (this->m_event & MMLEVT_CUT);
 
-    //decode sharp or flat notes
-    if ((*it == '#') || (*it =='+'))
+    //transpose the note if required (clamped to the table, invalid notes stay silent)
+    unsigned char note = this->m_event & MMLEVT_PITCH;
+    if(this->m_transpose && note <= NOTE_B8)
     {
-        note++;
-        it++;
-    }
-    if (*it == '-')
-    {
-        note--;
-        it++;
+      const int transposed = note + this->m_transpose;
+      note = (transposed < NOTE_A0 ? NOTE_A0 : transposed > NOTE_B8 ? NOTE_B8 : transposed);
     }
 
     //play the note
-    // + set the flag to decode next note on 2nd tick
-    tone(this->pin, this->getFrequency(note));
+    // + set the flag to start decoding the next note on 2nd tick
+    this->m_output->play(this->pin, note, this->m_ratio);
     this->isRefreshed = true;
 
-    ///////////////////////////////////////////////////////////////////////////////
-    //                           DURATION DECODING                               //
-    ///////////////////////////////////////////////////////////////////////////////
+    //decrement tick count (1 cycle is used to refresh note)
+    this->m_nbtick--;
 
-    //decode note duration (possible 2 digits)
-    if(isdigit(*it))
-    {
-      duration = *it - 48;
-      it++;
-    }
-    if(isdigit(*it))
-    {
-      duration = (duration * 10) + (*it - 48);
-      it++;
-    }
+    return 0;
+}
 
-    //if no duration specified for current note, reuse last specified
-    //otherwise, update notes duration
-    if(!duration)
-      duration = this->m_duration;
-    else
-      this->m_duration = duration;
+/****************************************************************/
+/*  I : MML token copied from a source (NUL-terminated)         */
+/*  P : Decodes the whole token into an event                   */
+/*  O : Event                                                   */
+/****************************************************************/
+uint16_t MMLtone::decode(const char* buffer)
+{
+    return MMLdecode(buffer, this->m_octave, this->m_duration);
+}
 
-    //set the number of ticks
-    // (nb of ticks = nb of 1/64 notes to reach proper duration)
-    this->m_nbtick = 64 / duration;
+/****************************************************************/
+/*  I : /                                                       */
+/*  P : Executes the command held in the buffer, if any         */
+/*      (T<bpm> : tempo change, [ and ]n : repeated section,    */
+/*      see MMLrepeat.h)                                        */
+/*  O : true if a command has been executed, false if a note is */
+/*        held instead                                          */
+/****************************************************************/
+bool MMLtone::command()
+{
+    //a source read only forward can not jump back (see MMLstreamSource)
+    const bool sequential = (this->isSourced && this->m_source->sequential());
 
-    //decode dotted note (duration * 1.5)
-    if (*it == '.')
-    {
-        this->m_nbtick += this->m_nbtick >> 1;
-        it++;
-    }
+    switch(MMLexecute(this->m_event, this->m_repeats, this->m_next, this->m_octave, this->m_duration, sequential)){
+      case MMLRUN_NOTE:
+          return false;
 
-    //if note is to be cut (ends with '/'), set the flag to noTone() for the last tick
-    if (*it == '/')
-        this->cut_note = true;
+      case MMLRUN_TEMPO:
+          this->m_tempo.set(this->m_event >> MMLEVT_TSHIFT);
+          return true;
 
-    //decrement tick count (1 cycle is used to refresh note)
-    this->m_nbtick--;
+      case MMLRUN_ENVELOPE:
+          this->m_output->envelope(this->pin, (this->m_event & MMLEVT_PITCH) - MMLEVT_ENVELOPE, this->m_event >> MMLEVT_TSHIFT);
+          return true;
 
-    return 0;
+      default:
+          return true;
+    }
 }
 
 /****************************************************************/
 /*  I : /                                                       */
-/*  P : Fetches the next note in memory and loads in in the buf.*/
+/*  P : Reads the token at m_next, decodes it into m_event      */
+/*        and moves m_next past it                              */
 /*  O : /                                                       */
 /****************************************************************/
-void MMLtone::getNextNote(){
-  //if note is not to be refreshed, exit
-  if(this->m_next>0 && !this->isRefreshed)
+void MMLtone::fetch(){
+  //pre-decoded events are read in one go
+  if(this->isCompiled)
+  {
+    this->m_event = pgm_read_word_near(this->m_events + this->m_next);
+    this->m_next++;
     return;
+  }
 
+  //packed tokens are decoded in a bounded amount of reads,
+  //  with the previous pitch in place of the octave
+  if(this->isPacked)
+  {
+    this->m_event = MMLunpack(this->m_packed, this->m_size, this->m_next, this->m_octave, this->m_duration);
+    return;
+  }
+
+  //other sources copy the whole note in one call
+  //  (nothing is read if it has not been received yet, m_next stays in place)
+  if(this->isSourced)
+  {
+    char buffer[NOTBUFSZ];
+    const unsigned char length = this->m_source->fetch(this->m_next, buffer, NOTBUFSZ - 1);
+    if(!length)
+      return;
+    this->m_next += length;
+    this->m_event = this->decode(buffer);
+    return;
+  }
+
+  //MML code in PROGMEM is decoded straight from it, character by character
+  this->m_event = 0;
+  this->m_decode = MMLDEC_FIRST;
+  this->read(MMLDEC_ALL);
+}
+
+/****************************************************************/
+/*  I : Maximum amount of characters to read                    */
+/*  P : Reads a few more characters of the token of MML code    */
+/*        being decoded (the separator is skipped, and a token  */
+/*        longer than NOTBUFSZ - 1 characters is split, as when */
+/*        copied from a source)                                 */
+/*  O : /                                                       */
+/****************************************************************/
+void MMLtone::read(unsigned char chars)
+{
+  unsigned char step = this->m_decode & MMLDEC_STEP;
+  unsigned char length = this->m_decode >> MMLDEC_LSHIFT;
+  char c;
+
+  for( ; chars && step != MMLDEC_READY ; chars--)
+  {
+    //end of the code, separator or token too long : end the token
+    c = (this->m_next < this->m_size ? pgm_read_byte_near(this->m_code + this->m_next) : '\0');
+    if(this->m_next < this->m_size && (c == ' ' || c == '\0'))
+      this->m_next++;
+    else if(this->m_next < this->m_size && length < NOTBUFSZ - 1)
+    {
+      step = MMLparse(step, c, this->m_event, this->m_octave, this->m_duration);
+      this->m_next++;
+      length++;
+      continue;
+    }
+    step = MMLparse(step, '\0', this->m_event, this->m_octave, this->m_duration);
+  }
+  this->m_decode = (step == MMLDEC_READY ? MMLDEC_READY : (length << MMLDEC_LSHIFT) | step);
+}
+
+/****************************************************************/
+/*  I : Maximum amount of characters of MML code to read        */
+/*  P : Starts decoding the token at m_next (switching to the   */
+/*        next song of the playlist at the end of the current   */
+/*        one), and reads the first characters of MML code      */
+/*  O : /                                                       */
+/****************************************************************/
+void MMLtone::advance(const unsigned char chars){
   //update current note index
   this->m_current = this->m_next;
 
-  //if last byte of the MML code has already been read, exit
-  if(this->m_next >= this->m_size)
+  //if last byte of the MML code has already been read, fetch the first note
+  //  of the next song of the playlist while the last one is playing (or exit)
+  if(this->m_next >= this->m_size && !this->nextSong())
     return;
 
-  //read the EEPROM memory byte by byte to retrieve the next note
-  //  and put the note in the buffer
-  unsigned char i=0;
-  do
+  //events, packed songs and sources are read in one go
+  if(this->isCompiled || this->isPacked || this->isSourced)
   {
-    this->m_buffer[i] = pgm_read_word_near(this->m_code + this->m_next);
-    this->m_next++;
-    i++;
-  }while(this->m_next < this->m_size && i<NOTBUFSZ && this->m_buffer[i-1]!=' '&& this->m_buffer[i-1]!='\0');
-  this->m_buffer[i] = '\0';
+    this->fetch();
+    return;
+  }
+
+  this->m_event = 0;
+  this->m_decode = MMLDEC_FIRST;
+  this->read(chars);
+}
+
+/****************************************************************/
+/*  I : /                                                       */
+/*  P : Starts decoding the next note on the 2nd tick of each   */
+/*        note, then reads MMLDECODECHARS more characters of it */
+/*        on each of the following ticks                        */
+/*  O : /                                                       */
+/****************************************************************/
+void MMLtone::getNextNote(){
+  MMLPROBE(this->m_fetchProfile);
+
+  //next note being decoded, read a few more characters of it
+  if(this->m_decode)
+  {
+    this->read(MMLDECODECHARS);
+    return;
+  }
+
+  //if note is not to be refreshed, exit
+  if(this->m_next>0 && !this->isRefreshed)
+    return;
+
+  this->advance(MMLDECODECHARS);
 }
 
 /****************************************************************
@@ -281,470 +454,489 @@ void MMLtone::getNextNote(){
  * O : /                                                        *
  ****************************************************************/
 void MMLtone::stop(){
-    noTone(this->pin);
+    this->m_output->mute(this->pin);
     this->isStarted=false;
 }
 
 /****************************************************************
  * I : /                                                        *
- * P : Reset all the flags to 0                                 *
+ * P : Reset all the flags to 0, and the tempo to MMLDEFTEMPO   *
+ *     (as at the beginning of the song, see seekToTick())      *
  * O : /                                                        *
  ****************************************************************/
 void MMLtone::reset(){
+  this->m_tempo.set(MMLDEFTEMPO);
   this->lastnote=false;
   this->isFinished=false;
   this->m_next = 0;
   this->m_current = 0;
+  this->m_repeats.depth = 0;
+  this->m_octave = 0;
+  this->m_duration = MMLDEFTICKS;
+  this->m_nbtick = 0;
+  this->cut_note = false;
+  this->isRefreshed = false;
+  this->m_decode = MMLDEC_READY;
 }
 
 /****************************************************************
- * I : /                                                        *
- * P : Inform about whether the melody is started or not        *
- * O : Melody state                                             *
+ * I : Index of a note in the MML code (or of an event)         *
+ * P : Resume playing from the given note, on the next tick     *
+ *     (octave and duration stay the ones in use, repeats are   *
+ *      left, and MMLstreamSource can not seek)                 *
+ * O : /                                                        *
  ****************************************************************/
-bool MMLtone::started()
-{
-  return this->isStarted;
+void MMLtone::seek(const unsigned int pos){
+  this->lastnote = false;
+  this->isFinished = false;
+  this->m_next = (pos < this->m_size ? pos : this->m_size);
+  this->m_current = this->m_next;
+  this->m_repeats.depth = 0;
+  this->m_nbtick = 0;
+  this->cut_note = false;
+  this->m_decode = MMLDEC_READY;
+
+  //have getNextNote() fetch the note right away
+  this->isRefreshed = true;
 }
 
 /****************************************************************
- * I : /                                                        *
- * P : Inform about whether the melody is finished or not       *
- * O : Melody state                                             *
+ * I : Tick to reach (from the beginning of the song)           *
+ * P : Resume playing from the note played at that tick,        *
+ *     walking the song from its beginning                      *
+ * O : Tick at which that note starts                           *
  ****************************************************************/
-bool MMLtone::finished()
-{
-  return this->isFinished;
+unsigned long MMLtone::seekToTick(const unsigned long tick){
+  //the tempo in use at the start of the song is the default one, until its first T command
+  const MMLcheckpoint start = {0, 0, 0, MMLDEFTICKS, MMLDEFTEMPO};
+  return this->scan(start, tick);
 }
 
 /****************************************************************
- * I : /                                                        *
- * P : Informs about whether the last tone is reached or not    *
- * O : Melody state                                             *
+ * I : Tick to reach (from the beginning of the song)           *
+ *     Index of the song (see MMLindex.h)                       *
+ * P : Resume playing from the note played at that tick,        *
+ *     walking the song from the last checkpoint before it      *
+ * O : Tick at which that note starts                           *
  ****************************************************************/
-bool MMLtone::last()
-{
-  return this->lastnote;
+unsigned long MMLtone::seekToTick(const unsigned long tick, const MMLindex& index){
+  return this->scan(index.find(tick), tick);
 }
 
 /****************************************************************
- * I : /                                                        *
- * P : Informs about whether the last tone is reached or not    *
- * O : Melody state                                             *
+ * I : Bar to reach (0 for the first one, see MMLBARTICKS)      *
+ * P : Resume playing from the beginning of the bar             *
+ * O : Tick at which the note played then starts                *
  ****************************************************************/
-bool MMLtone::refreshed()
-{
-  return this->isRefreshed;
+unsigned long MMLtone::seekToBar(const unsigned int bar){
+  return this->seekToTick((unsigned long)bar * MMLBARTICKS);
 }
 
 /****************************************************************
- * I : Index of a note compared to the A at the octave 0        *
- *     Indexes are declared in pitches.h                        *
- *        e.g. : C@3 = 2 octaves + place of C in the octave     *
- *                   = 2*12 + 3 = 27                            *
- * P : Get the corresponding frequency for a note               *
- * O : Frequency of the note                                    *
+ * I : Bar to reach (0 for the first one, see MMLBARTICKS)      *
+ *     Index of the song (see MMLindex.h)                       *
+ * P : Resume playing from the beginning of the bar             *
+ * O : Tick at which the note played then starts                *
  ****************************************************************/
-float MMLtone::getFrequency(const unsigned char note){
-  switch(note){
-    case NOTE_A0:     // A @ octave 0
-      return 27.50;
-      break;
-
-    case NOTE_As0:     // A#/Bb @ octave 0
-      return 29.14;
-      break;
-
-    case NOTE_B0:    // B @ octave 0
-      return 30.87;
-      break;
-      
-    case NOTE_C1:     //C @ octave 1
-      return 32.70;
-      break;
-
-    case NOTE_Cs1:     // C#/Db @ octave 1
-      return 34.65;
-      break;
-
-    case NOTE_D1:     // D @ octave 1
-      return 36.71;
-      break;
-
-    case NOTE_Ds1:     // D#/Eb @ octave 1
-      return 38.89;
-      break;
-
-    case NOTE_E1:     // E @ octave 1
-      return 41.20;
-      break;
-
-    case NOTE_F1:     // F @ octave 1
-      return 43.65;
-      break;
-
-    case NOTE_Fs1:     // F#/Gb @ octave 1
-      return 46.25;
-      break;
-
-    case NOTE_G1:     // G @ octave 1
-      return 49.00;
-      break;
-
-    case NOTE_Gs1:    // G#/Ab @ octave 1
-      return 51.91;
-      break;
-
-    case NOTE_A1:     // A @ octave 1
-      return 55.00;
-      break;
-
-    case NOTE_As1:     // A#/Bb @ octave 1
-      return 58.27;
-      break;
-
-    case NOTE_B1:    // B @ octave 1
-      return 61.74;
-      break;
-      
-    case NOTE_C2:     //C @ octave 2
-      return 65.41;
-      break;
-
-    case NOTE_Cs2:     // C#/Db @ octave 2
-      return 69.30;
-      break;
-
-    case NOTE_D2:     // D @ octave 2
-      return 73.42;
-      break;
-
-    case NOTE_Ds2:     // D#/Eb @ octave 2
-      return 77.78;
-      break;
-
-    case NOTE_E2:     // E @ octave 2
-      return 82.41;
-      break;
-
-    case NOTE_F2:     // F @ octave 2
-      return 87.31;
-      break;
-
-    case NOTE_Fs2:     // F#/Gb @ octave 2
-      return 92.50;
-      break;
-
-    case NOTE_G2:     // G @ octave 2
-      return 98.00;
-      break;
-
-    case NOTE_Gs2:    // G#/Ab @ octave 2
-      return 103.83;
-      break;
-
-    case NOTE_A2:     // A @ octave 2
-      return 110.00;
-      break;
-
-    case NOTE_As2:     // A#/Bb @ octave 2
-      return 116.54;
-      break;
-
-    case NOTE_B2:    // B @ octave 2
-      return 123.47;
-      break;
-      
-    case NOTE_C3:     //C @ octave 3
-      return 130.81;
-      break;
-
-    case NOTE_Cs3:     // C#/Db @ octave 3
-      return 138.59;
-      break;
-
-    case NOTE_D3:     // D @ octave 3
-      return 146.83;
-      break;
-
-    case NOTE_Ds3:     // D#/Eb @ octave 3
-      return 155.56;
-      break;
-
-    case NOTE_E3:     // E @ octave 3
-      return 164.81;
-      break;
-
-    case NOTE_F3:     // F @ octave 3
-      return 174.61;
-      break;
-
-    case NOTE_Fs3:     // F#/Gb @ octave 3
-      return 185.00;
-      break;
-
-    case NOTE_G3:     // G @ octave 3
-      return 196.00;
-      break;
-
-    case NOTE_Gs3:    // G#/Ab @ octave 3
-      return 207.65;
-      break;
-
-    case NOTE_A3:     // A @ octave 3
-      return 220.00;
-      break;
-
-    case NOTE_As3:     // A#/Bb @ octave 3
-      return 233.08;
-      break;
-
-    case NOTE_B3:    // B @ octave 3
-      return 246.94;
-      break;
-      
-    case NOTE_C4:     //C @ octave 4
-      return 261.63;
-      break;
-
-    case NOTE_Cs4:     // C#/Db @ octave 4
-      return 277.18;
-      break;
-
-    case NOTE_D4:     // D @ octave 4
-      return 293.66;
-      break;
-
-    case NOTE_Ds4:     // D#/Eb @ octave 4
-      return 311.13;
-      break;
-
-    case NOTE_E4:     // E @ octave 4
-      return 329.63;
-      break;
-
-    case NOTE_F4:     // F @ octave 4
-      return 349.23;
-      break;
-
-    case NOTE_Fs4:     // F#/Gb @ octave 4
-      return 369.99;
-      break;
-
-    case NOTE_G4:     // G @ octave 4
-      return 392.00;
-      break;
-
-    case NOTE_Gs4:    // G#/Ab @ octave 4
-      return 415.30;
-      break;
-
-    case NOTE_A4:     // A @ octave 4
-      return 440.00;
-      break;
-
-    case NOTE_As4:     // A#/Bb @ octave 4
-      return 466.16;
-      break;
-
-    case NOTE_B4:    // B @ octave 4
-      return 493.88;
-      break;
-      
-    case NOTE_C5:     //C @ octave 5
-      return 523.25;
-      break;
-
-    case NOTE_Cs5:     // C#/Db @ octave 5
-      return 554.37;
-      break;
-
-    case NOTE_D5:     // D @ octave 5
-      return 587.33;
-      break;
-
-    case NOTE_Ds5:     // D#/Eb @ octave 5
-      return 622.25;
-      break;
-
-    case NOTE_E5:     // E @ octave 5
-      return 659.25;
-      break;
-
-    case NOTE_F5:     // F @ octave 5
-      return 698.46;
-      break;
-
-    case NOTE_Fs5:     // F#/Gb @ octave 5
-      return 739.99;
-      break;
-
-    case NOTE_G5:     // G @ octave 5
-      return 783.99;
-      break;
+unsigned long MMLtone::seekToBar(const unsigned int bar, const MMLindex& index){
+  return this->seekToTick((unsigned long)bar * MMLBARTICKS, index);
+}
 
-    case NOTE_Gs5:    // G#/Ab @ octave 5
-      return 830.61;
-      break;
+/****************************************************************
+ * I : Checkpoint to start from                                 *
+ *     Tick to reach (from the beginning of the song)           *
+ * P : Restore the checkpoint, then walk the tokens up to the   *
+ *     note played at that tick, on which the melody resumes    *
+ *     (the commands met are executed, the notes only counted)  *
+ * O : Tick at which that note starts (the length of the song   *
+ *     if the tick is past its end)                             *
+ ****************************************************************/
+unsigned long MMLtone::scan(const MMLcheckpoint& from, const unsigned long tick){
+  unsigned long now = from.tick;
+  unsigned int pos;
+  unsigned char octave, duration;
+
+  this->lastnote = false;
+  this->isFinished = false;
+  this->m_next = (from.pos < this->m_size ? from.pos : this->m_size);
+  this->m_octave = from.octave;
+  this->m_duration = from.duration;
+  this->m_repeats.depth = 0;
+  this->m_nbtick = 0;
+  this->cut_note = false;
+  this->m_decode = MMLDEC_READY;
+  if(from.bpm)
+    this->m_tempo.set(from.bpm);
+
+  while(this->m_next < this->m_size)
+  {
+    pos = this->m_next;
+    octave = this->m_octave;
+    duration = this->m_duration;
+    this->fetch();
 
-    case NOTE_A5:     // A @ octave 5
-      return 880.00;
+    //nothing received from the source (see MMLstreamSource)
+    if(this->m_next == pos)
       break;
+    if(this->command())
+      continue;
 
-    case NOTE_As5:     // A#/Bb @ octave 5
-      return 932.33;
+    //the note is fetched again when resuming (from the octave, or previous pitch, and duration before it)
+    const unsigned char ticks = (this->m_event & MMLEVT_TICKS) >> MMLEVT_TSHIFT;
+    if(now + ticks > tick)
+    {
+      this->m_next = pos;
+      this->m_octave = octave;
+      this->m_duration = duration;
       break;
+    }
+    now += ticks;
+  }
 
-    case NOTE_B5:    // B @ octave 5
-      return 987.77;
-      break;
-      
-    case NOTE_C6:     //C @ octave 6
-      return 1046.50;
-      break;
+  //have getNextNote() fetch the note right away
+  this->m_current = this->m_next;
+  this->isRefreshed = true;
+  return now;
+}
 
-    case NOTE_Cs6:     // C#/Db @ octave 6
-      return 1108.73;
-      break;
+/****************************************************************
+ * I : Array receiving the checkpoints                          *
+ *     Maximum amount of checkpoints                            *
+ *     Minimum amount of ticks between two checkpoints          *
+ * P : Walk the whole song and take a checkpoint every few      *
+ *     ticks, outside of the repeated sections (see MMLindex.h) *
+ *     The melody is rewound, and is not to be playing          *
+ * O : Amount of checkpoints taken                              *
+ ****************************************************************/
+unsigned int MMLtone::index(MMLcheckpoint* checkpoints, const unsigned int max, const unsigned int every){
+  const unsigned int bpm = this->m_tempo.bpm();
+  unsigned long now = 0, next = 0;
+  unsigned int count = 0, songbpm = MMLDEFTEMPO;
 
-    case NOTE_D6:     // D @ octave 6
-      return 1174.66;
-      break;
+  this->reset();
+  while(this->m_next < this->m_size)
+  {
+    if(!this->m_repeats.depth && now >= next && count < max)
+    {
+      MMLcheckpoint* checkpoint = checkpoints + count;
+      checkpoint->tick = now;
+      checkpoint->pos = this->m_next;
+      checkpoint->octave = this->m_octave;
+      checkpoint->duration = this->m_duration;
+      checkpoint->bpm = songbpm;
+      count++;
+      next = now + every;
+    }
 
-    case NOTE_Ds6:     // D#/Eb @ octave 6
-      return 1244.51;
+    //nothing received from the source (see MMLstreamSource)
+    const unsigned int pos = this->m_next;
+    this->fetch();
+    if(this->m_next == pos)
       break;
+    if(this->command())
+    {
+      if((this->m_event & MMLEVT_PITCH) == MMLEVT_TEMPO)
+        songbpm = this->m_tempo.bpm();
+      continue;
+    }
+    now += (this->m_event & MMLEVT_TICKS) >> MMLEVT_TSHIFT;
+  }
 
-    case NOTE_E6:     // E @ octave 6
-      return 1318.51;
-      break;
+  //the tempo changes met are not kept
+  this->reset();
+  this->m_tempo.set(bpm);
+  return count;
+}
 
-    case NOTE_F6:     // F @ octave 6
-      return 1396.91;
-      break;
+/****************************************************************
+ * I : Pointer to the MML string                                *
+ *     Size of the code array (sizeof())                        *
+ * P : Stop the melody and replace its song                     *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLtone::load(const char* code, const unsigned int siz){
+  this->load(MMLsong(code, siz));
+}
 
-    case NOTE_Fs6:     // F#/Gb @ octave 6
-      return 1479.98;
-      break;
+/****************************************************************
+ * I : Pointer to the pre-decoded events (see MMLcompiler.h)    *
+ *     Amount of events                                         *
+ * P : Stop the melody and replace its song                     *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLtone::load(const uint16_t* events, const unsigned int count){
+  this->load(MMLsong(events, count));
+}
 
-    case NOTE_G6:     // G @ octave 6
-      return 1567.98;
-      break;
+/****************************************************************
+ * I : Pointer to the packed song (see MMLpacked.h)             *
+ *     Size of the packed song (sizeof())                       *
+ * P : Stop the melody and replace its song                     *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLtone::load(const uint8_t* packed, const unsigned int siz){
+  this->load(MMLsong(packed, siz));
+}
 
-    case NOTE_Gs6:    // G#/Ab @ octave 6
-      return 1661.22;
-      break;
+/****************************************************************
+ * I : Source providing the MML code (see MMLsource.h)          *
+ * P : Stop the melody and replace its song                     *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLtone::load(MMLsource& source){
+  this->load(MMLsong(source));
+}
 
-    case NOTE_A6:     // A @ octave 6
-      return 1760.00;
-      break;
+/****************************************************************
+ * I : Song to play (see MMLplaylist.h)                         *
+ * P : Stop the melody and replace its song                     *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLtone::load(const MMLsong& song){
+  this->stop();
+  this->m_playlist = 0;
+  this->assign(song);
+  this->reset();
+}
 
-    case NOTE_As6:     // A#/Bb @ octave 6
-      return 1864.66;
-      break;
+/****************************************************************
+ * I : Songs to play one after the other (see MMLplaylist.h)    *
+ * P : Stop the melody and replace its song by the first one of *
+ *     the playlist, the others following without any gap      *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLtone::load(MMLplaylist& playlist){
+  const MMLsong* song = playlist.first();
 
-    case NOTE_B6:    // B @ octave 6
-      return 1975.53;
-      break;
-      
-    case NOTE_C7:     //C @ octave 7
-      return 2093.00;
-      break;
+  this->load(song ? *song : MMLsong());
+  this->m_playlist = &playlist;
+}
 
-    case NOTE_Cs7:     // C#/Db @ octave 7
-      return 2217.46;
-      break;
+/****************************************************************
+ * I : Output producing the notes (see MMLoutput.h)             *
+ * P : Change the output of the melody (to be called before     *
+ *     setup(), while stopped)                                  *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLtone::setOutput(MMLoutput& output){
+  this->m_output = &output;
+}
 
-    case NOTE_D7:     // D @ octave 7
-      return 2349.32;
-      break;
+/****************************************************************
+ * I : Semitones added to the notes (negative to lower them)    *
+ * P : Transpose the notes played from the next one on          *
+ *     (clamped to A0 - B8, 0 to play them as written)          *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLtone::setTranspose(const int semitones){
+  this->m_transpose = (semitones < -NOTE_B8 ? -NOTE_B8 : semitones > NOTE_B8 ? NOTE_B8 : semitones);
+}
 
-    case NOTE_Ds7:     // D#/Eb @ octave 7
-      return 2489.02;
-      break;
+/****************************************************************
+ * I : Cents added to the notes (-MMLMAXDETUNE to MMLMAXDETUNE) *
+ * P : Detune the notes played from the next one on            *
+ *     (0 to play them in tune)                                 *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLtone::setDetune(const int cents){
+  this->m_ratio = MMLpitch::ratio(cents < -MMLMAXDETUNE ? -MMLMAXDETUNE : cents > MMLMAXDETUNE ? MMLMAXDETUNE : cents);
+}
 
-    case NOTE_E7:     // E @ octave 7
-      return 2637.02;
-      break;
+/****************************************************************
+ * I : /                                                        *
+ * P : Get the transposition of the notes                       *
+ * O : Semitones added to the notes                             *
+ ****************************************************************/
+int MMLtone::transpose(){
+  return this->m_transpose;
+}
 
-    case NOTE_F7:     // F @ octave 7
-      return 2793.83;
-      break;
+/****************************************************************
+ * I : Song to play                                             *
+ * P : Point the melody to a song (without stopping it)         *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLtone::assign(const MMLsong& song){
+  switch(song.type){
+    case MMLSONG_EVENTS:
+        this->m_events = (const uint16_t*)song.data;
+        break;
+
+    case MMLSONG_SOURCE:
+        this->m_source = (MMLsource*)song.data;
+        break;
+
+    case MMLSONG_PACKED:
+        this->m_packed = (const uint8_t*)song.data;
+        break;
+
+    default:
+        this->m_code = (const char*)song.data;
+        break;
+  }
+  this->m_size = song.size;
+  this->isCompiled = (song.type == MMLSONG_EVENTS);
+  this->isSourced = (song.type == MMLSONG_SOURCE);
+  this->isPacked = (song.type == MMLSONG_PACKED);
+}
 
-    case NOTE_Fs7:     // F#/Gb @ octave 7
-      return 2959.96;
-      break;
+/****************************************************************
+ * I : /                                                        *
+ * P : Switch to the next song of the playlist, from its start  *
+ *     (the last note of the current one may still be playing)  *
+ * O : true if switched, false if the playlist is over          *
+ ****************************************************************/
+bool MMLtone::nextSong(){
+  if(!this->m_playlist)
+    return false;
 
-    case NOTE_G7:     // G @ octave 7
-      return 3135.96;
-      break;
+  const MMLsong* song = this->m_playlist->next();
+  if(!song)
+    return false;
 
-    case NOTE_Gs7:    // G#/Ab @ octave 7
-      return 3322.44;
-      break;
+  this->assign(*song);
+  this->m_next = 0;
+  this->m_current = 0;
+  this->m_repeats.depth = 0;
+  this->m_octave = 0;
+  this->m_duration = MMLDEFTICKS;
+  return true;
+}
 
-    case NOTE_A7:     // A @ octave 7
-      return 3520.00;
-      break;
+/****************************************************************
+ * I : /                                                        *
+ * P : Compute the amount of ticks to come during which onTick()*
+ *     and getNextNote() would only decrement the tick counter  *
+ * O : Amount of quiet ticks (MMLIDLE if not playing)           *
+ ****************************************************************/
+unsigned char MMLtone::quietTicks(){
+  //nothing happens until the melody is (re)started
+  if(!this->isStarted || this->isFinished)
+    return MMLIDLE;
 
-    case NOTE_As7:     // A#/Bb @ octave 7
-      return 3729.31;
-      break;
+  //next note to be fetched or being decoded, or current note ending
+  if(this->isRefreshed || this->m_decode || !this->m_nbtick)
+    return 0;
 
-    case NOTE_B7:    // B @ octave 7
-      return 3951.07;
-      break;
-      
-    case NOTE_C8:     //C @ octave 8
-      return 4186.01;
-      break;
+  //the clear-cut happens on the last tick
+  unsigned char quiet = (this->cut_note ? this->m_nbtick - 1 : this->m_nbtick);
+  return (quiet < MMLIDLE ? quiet : MMLIDLE - 1);
+}
 
-    case NOTE_Cs8:     // C#/Db @ octave 8
-      return 4434.92;
-      break;
+/****************************************************************
+ * I : Amount of ticks to skip (at most quietTicks())           *
+ * P : Apply several quiet ticks at once                        *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLtone::skip(const unsigned char ticks){
+  this->m_nbtick -= ticks;
+}
 
-    case NOTE_D8:     // D @ octave 8
-      return 4698.63;
-      break;
+/****************************************************************
+ * I : /                                                        *
+ * P : Advance the tempo by one clock period                    *
+ *     (to be called at MMLCLOCKHZ, see MMLtempo.h)             *
+ * O : true if getNextNote() and onTick() are due               *
+ ****************************************************************/
+bool MMLtone::clock(){
+  return this->m_tempo.clock();
+}
 
-    case NOTE_Ds8:     // D#/Eb @ octave 8
-      return 4978.03;
-      break;
+/****************************************************************
+ * I : Tempo (in beats per minute, 1 to MMLMAXTEMPO)            *
+ * P : Change the tempo at which clock() generates the ticks    *
+ *     (back to MMLDEFTEMPO once the song is rewound)           *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLtone::setTempo(const unsigned int bpm){
+  this->m_tempo.set(bpm);
+}
 
-    case NOTE_E8:     // E @ octave 8
-      return 5274.04;
-      break;
+/****************************************************************
+ * I : /                                                        *
+ * P : Get the tempo at which clock() generates the ticks       *
+ * O : Tempo (in beats per minute)                              *
+ ****************************************************************/
+unsigned int MMLtone::tempo(){
+  return this->m_tempo.bpm();
+}
 
-    case NOTE_F8:     // F @ octave 8
-      return 5587.65;
-      break;
+/****************************************************************
+ * I : /                                                        *
+ * P : Inform about whether the melody is started or not        *
+ * O : Melody state                                             *
+ ****************************************************************/
+bool MMLtone::started()
+{
+  return this->isStarted;
+}
 
-    case NOTE_Fs8:     // F#/Gb @ octave 8
-      return 5919.91;
-      break;
+/****************************************************************
+ * I : /                                                        *
+ * P : Get the index of the note being played                   *
+ * O : Index in the MML code (or of the event)                  *
+ ****************************************************************/
+unsigned int MMLtone::position()
+{
+  return this->m_current;
+}
 
-    case NOTE_G8:     // G @ octave 8
-      return 6271.93;
-      break;
+/****************************************************************
+ * I : /                                                        *
+ * P : Inform about whether the melody is finished or not       *
+ * O : Melody state                                             *
+ ****************************************************************/
+bool MMLtone::finished()
+{
+  return this->isFinished;
+}
 
-    case NOTE_Gs8:    // G#/Ab @ octave 8
-      return 6644.88;
-      break;
+/****************************************************************
+ * I : /                                                        *
+ * P : Informs about whether the last tone is reached or not    *
+ * O : Melody state                                             *
+ ****************************************************************/
+bool MMLtone::last()
+{
+  return this->lastnote;
+}
 
-    case NOTE_A8:     // A @ octave 8
-      return 7040.00;
-      break;
+/****************************************************************
+ * I : /                                                        *
+ * P : Informs about whether the last tone is reached or not    *
+ * O : Melody state                                             *
+ ****************************************************************/
+bool MMLtone::refreshed()
+{
+  return this->isRefreshed;
+}
 
-    case NOTE_As8:     // A#/Bb @ octave 8
-      return 7458.62;
-      break;
+#ifdef MMLPROFILE
+/****************************************************************
+ * I : /                                                        *
+ * P : Get the statistics of the durations of onTick()          *
+ * O : Statistics                                               *
+ ****************************************************************/
+MMLprofile& MMLtone::tickProfile(){
+  return this->m_tickProfile;
+}
 
-    case NOTE_B8:    // B @ octave 8
-      return 7902.13;
-      break;
+/****************************************************************
+ * I : /                                                        *
+ * P : Get the statistics of the durations of getNextNote()     *
+ * O : Statistics                                               *
+ ****************************************************************/
+MMLprofile& MMLtone::fetchProfile(){
+  return this->m_fetchProfile;
+}
 
-    default :       //code does not match any note
-      return 0.0;
-      break;
-  } 
+/****************************************************************
+ * I : Output receiving the report (e.g. Serial)                *
+ * P : Print the statistics of onTick() and getNextNote()       *
+ * O : /                                                        *
+ ****************************************************************/
+void MMLtone::dumpProfile(Print& out){
+  this->m_tickProfile.dump(out, "onTick");
+  this->m_fetchProfile.dump(out, "getNextNote");
 }
+#endif
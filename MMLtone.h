@@ -1,32 +1,142 @@
 #ifndef MUSIC_H_INCLUDED
 #define MUSIC_H_INCLUDED
 
+#include <stdint.h>
+#include "MMLsource.h"
+#include "MMLtempo.h"
+#include "MMLplaylist.h"
+#include "MMLprofile.h"
+#include "MMLoutput.h"
+#include "MMLindex.h"
+
 #define NOTBUFSZ 8
+#define MMLDEFDURATION 4        //duration of the notes until one is specified (quarter note)
+#define MMLDEFTICKS   (MMLRESOLUTION / MMLDEFDURATION)  //amount of ticks of that duration
+
+//layout of a pre-decoded note event (see MMLcompiler.h)
+#define MMLEVT_PITCH  0x007F    //pitch index (see pitches.h), MMLEVT_PITCH if no valid pitch
+#define MMLEVT_TICKS  0x7F80    //amount of ticks the note lasts
+#define MMLEVT_CUT    0x8000    //clear-cut on the last tick
+#define MMLEVT_TSHIFT 7         //position of the ticks in the event
+#define MMLEVT_TEMPO  0x007E    //pitch of a tempo change event (the BPM replaces the ticks and clear-cut)
+#define MMLEVT_LOOP   0x007D    //pitch of a section beginning event ([)
+#define MMLEVT_REPEAT 0x007C    //pitch of a section end event (]n, n replaces the ticks and clear-cut)
+#define MMLEVT_ENVELOPE 0x0078  //pitch of the first envelope event (@A, then @D, @S and @R up to 0x7B, the value replaces the ticks)
+
+#define MMLIDLE       0xFF      //amount of quiet ticks of a melody which is not playing
+
+//steps of the decoding of a token of MML code, one character at a time (see MMLparse() in MMLparse.h)
+#define MMLDEC_READY  0         //no token being decoded (the next event is ready)
+#define MMLDEC_FIRST  1         //first character (octave, letter or command)
+#define MMLDEC_LETTER 2         //letter of the note, after its octave
+#define MMLDEC_SHARP  3         //sharp (# or +)
+#define MMLDEC_FLAT   4         //flat (-)
+#define MMLDEC_DUR1   5         //first digit of the duration
+#define MMLDEC_DUR2   6         //second digit of the duration
+#define MMLDEC_DOT    7         //dot
+#define MMLDEC_CUT    8         //clear-cut (/)
+#define MMLDEC_PARAM  9         //envelope parameter, after an @
+#define MMLDEC_ARG    10        //digits of the argument of a command
+#define MMLDEC_REST   11        //characters ignored up to the end of the token
+#define MMLDEC_STEP   0x0F      //step, in the decoding state
+#define MMLDEC_LSHIFT 4         //position of the amount of characters of the token read so far, in the decoding state
+#define MMLDEC_ALL    0xFF      //amount of characters read to decode a whole token at once
+
+#ifndef MMLDECODECHARS
+#define MMLDECODECHARS (NOTBUFSZ / 2)  //characters of the next token read by each getNextNote() (the whole token in 2 ticks)
+#endif
+static_assert(MMLDECODECHARS > 0 && MMLDECODECHARS < MMLDEC_ALL, "MMLDECODECHARS must be 1 to 254");
+
+//envelope parameter named by the letter following an @ (see MMLENV_* in MMLoutput.h)
+constexpr unsigned char MMLenvelopeParam(const char c){
+  return (c == 'A' || c == 'a' ? MMLENV_ATTACK
+        : c == 'D' || c == 'd' ? MMLENV_DECAY
+        : c == 'S' || c == 's' ? MMLENV_SUSTAIN
+        : c == 'R' || c == 'r' ? MMLENV_RELEASE
+        : MMLENV_NONE);
+}
+
+#ifndef MMLLOOPDEPTH
+#define MMLLOOPDEPTH  4         //maximum amount of nested repeated sections
+#endif
+static_assert(MMLLOOPDEPTH > 0 && MMLLOOPDEPTH <= 8, "MMLLOOPDEPTH must be 1 to 8");
+
+//repeated section being played
+struct MMLloop{
+  unsigned int        pos;                  //index of the first note of the section
+  unsigned char       count;                //amount of times the section is still to be played (0 until its end is reached)
+  unsigned char       octave;               //octave in use at the beginning of the section
+  unsigned char       duration;             //duration (in ticks) in use at the beginning of the section
+};
+
+//stack of the repeated sections being played (see MMLrepeat.h)
+struct MMLrepeats{
+  MMLloop             loops[MMLLOOPDEPTH];  //sections opened, the innermost one last
+  unsigned char       depth;                //amount of nested sections being played (deeper ones counted only)
+  unsigned char       played;               //bit of each section opened set once it has played a note (see MMLexecute())
+};
+
+//RAM allowed for each voice (MMLtone, without profiling) : fixed amounts, so that a field added to MMLtone
+//  fails the build until the budget is raised on purpose (49 bytes on AVR with 4 loops, 88 on 64-bit hosts)
+#ifdef __AVR__
+#define MMLVOICEBUDGET (29 + MMLLOOPDEPTH * 5)
+#else
+#define MMLVOICEBUDGET (56 + MMLLOOPDEPTH * 8)
+#endif
 
 class MMLtone
 { 
   private:
       unsigned char   pin;                  //pin to which output the Tone() signal
-      unsigned char   m_octave;             //octave in which the notes will be played until updated
+      unsigned char   m_octave;             //octave in which the notes will be played until updated (previous pitch if packed)
       unsigned char   m_nbtick;             //amount of ticks remaining to play the note (decrements while playing)
-      unsigned char   m_duration;           //duration or value of the notes until updated (e.g. : 1/16 note)
-      unsigned char   m_next;               //index of the next note in the MML code
-      unsigned char   m_current;            //index of the current note playing in the MML code
-      unsigned char   m_size;               //size (in bytes) of the whole MML code
-      char            m_buffer[NOTBUFSZ];   //buffer holding the next note played
-      char*           m_code;               //PROGMEM address of the entire MML code
-      bool            isFinished;           //flag indicating whether the last note has been played
-      bool            lastnote;             //flag indicating whether the last note is being played
-      bool            isStarted;            //flag indicating whether the music is to be played or not
-      bool            cut_note;             //flag indicating whether there is a clear-cut in the note
-      bool            isRefreshed;          //flag indicating whether the next note is to be read
+      unsigned char   m_duration;           //amount of ticks of the notes until updated (duration pre-multiplied)
+      bool            isFinished : 1;       //flag indicating whether the last note has been played
+      bool            lastnote : 1;         //flag indicating whether the last note is being played
+      bool            isStarted : 1;        //flag indicating whether the music is to be played or not
+      bool            cut_note : 1;         //flag indicating whether there is a clear-cut in the note
+      bool            isRefreshed : 1;      //flag indicating whether the next note is to be read
+      bool            isCompiled : 1;       //flag indicating whether the notes are pre-decoded events
+      bool            isSourced : 1;        //flag indicating whether the MML code comes from an MMLsource
+      bool            isPacked : 1;         //flag indicating whether the notes are packed (see MMLpacked.h)
+      signed char     m_transpose;          //semitones added to the notes played (0 if none)
+      unsigned char   m_decode;             //step of the token being decoded, and amount of its characters read (see MMLDEC_*)
+      uint16_t        m_event;              //next note played, decoded when fetched (see MMLEVT_*, partly decoded until m_decode is ready)
+      uint16_t        m_ratio;              //ratio of the detune applied to the notes played (MMLUNITY if none)
+      unsigned int    m_next;               //index of the next note in the MML code
+      unsigned int    m_current;            //index of the current note playing in the MML code
+      unsigned int    m_size;               //size (in bytes) of the whole MML code
+      union{
+        const char*   m_code;               //PROGMEM address of the entire MML code
+        const uint16_t* m_events;           //PROGMEM address of the pre-decoded events
+        const uint8_t*  m_packed;           //PROGMEM address of the packed song
+        MMLsource*    m_source;             //source providing the MML code
+      };
+      MMLtempo        m_tempo;              //tempo at which the ticks are generated by clock()
+      MMLrepeats      m_repeats;            //stack of the repeated sections being played
+      MMLplaylist*    m_playlist;           //songs following the current one (NULL if none)
+      MMLoutput*      m_output;             //output producing the notes (tone() by default)
+#ifdef MMLPROFILE
+      MMLprofile      m_tickProfile;        //durations of onTick()
+      MMLprofile      m_fetchProfile;       //durations of getNextNote()
+#endif
 
   protected:
     //declared as inline to avoid function calls and speed up process
-    inline float getFrequency(const unsigned char note) __attribute__((always_inline));
+    inline bool command() __attribute__((always_inline));
+    inline void fetch() __attribute__((always_inline));
+    uint16_t decode(const char* buffer);
+    void read(unsigned char chars);
+    void advance(const unsigned char chars);
+    unsigned long scan(const MMLcheckpoint& from, const unsigned long tick);
+    void assign(const MMLsong& song);
+    bool nextSong();
 
   public:
-      MMLtone(const unsigned char Pin, const char* code, const unsigned char siz);
+      MMLtone(const unsigned char Pin, const char* code, const unsigned int siz);
+      MMLtone(const unsigned char Pin, const uint16_t* events, const unsigned int count);
+      MMLtone(const unsigned char Pin, const uint8_t* packed, const unsigned int siz);
+      MMLtone(const unsigned char Pin, MMLsource& source);
       ~MMLtone();
       void setup();
       void start();
@@ -34,10 +144,37 @@ class MMLtone
       void getNextNote();
       void stop();
       void reset();
+      void seek(const unsigned int pos);
+      unsigned long seekToTick(const unsigned long tick);
+      unsigned long seekToTick(const unsigned long tick, const MMLindex& index);
+      unsigned long seekToBar(const unsigned int bar);
+      unsigned long seekToBar(const unsigned int bar, const MMLindex& index);
+      unsigned int index(MMLcheckpoint* checkpoints, const unsigned int max, const unsigned int every = MMLBARTICKS);
+      void load(const char* code, const unsigned int siz);
+      void load(const uint16_t* events, const unsigned int count);
+      void load(const uint8_t* packed, const unsigned int siz);
+      void load(MMLsource& source);
+      void load(const MMLsong& song);
+      void load(MMLplaylist& playlist);
+      void setOutput(MMLoutput& output);
+      void setTranspose(const int semitones);
+      void setDetune(const int cents);
+      int transpose();
+      unsigned char quietTicks();
+      void skip(const unsigned char ticks);
+      bool clock();
+      void setTempo(const unsigned int bpm);
+      unsigned int tempo();
 
       bool started();
       bool finished();
       bool last();
       bool refreshed();
+      unsigned int position();
+#ifdef MMLPROFILE
+      MMLprofile& tickProfile();
+      MMLprofile& fetchProfile();
+      void dumpProfile(Print& out);
+#endif
 };
 #endif
@@ -1,4 +1,7 @@
 #include "MMLtone.h"
+#include "MMLcontrol.h"
+#include "MMLvalidator.h"
+#include "MMLtimer.h"
 
 /*
  * Devices used during tests :
@@ -23,23 +26,22 @@
  *                    |   Each on the TC4428 outputs
  */
 
-//timer1 values with 16 MHz crystal
-// 1/64 notes are chosen as smallest musical increment
-// (value = 16,000,000 / (prescaler * Hz) - 1) -> must be < 65536 for timer1
-#define BPM120CRY 62499 // 32Hz tick (1/64 note at 120 BPM)
-#define BPM140CRY 53570 // 37.333Hz tick (1/64 note at 140 BPM)
-#define BPM160CRY 46873 // 42.667Hz tick (1/64 note at 160 BPM)
+//timer1 fires once per tick (1/MMLRESOLUTION note), at the tempo of the melody
+// (32 Hz at 120 BPM, the periods being computed from F_CPU, see MMLtimer.h),
+// rather than running a 1 kHz clock through MMLtone::clock()
+//MMLcontrol executes the commands of loop() and publishes the status on every tick :
+// the tickless mode of MMLsequencer::onTimer() would hold them for up to a whole
+// note, and suits the sketches without any MMLcontrol (see README.md)
+MMLtimer1 timer(120);
 
-//timer1 values with 8 MHz internal resonator
-// 1/64 notes are chosen as smallest musical increment
-// (value = 8,000,000 / (prescaler * Hz) - 1) -> must be < 65536 for timer1
-#define BPM120INT 31249 // 32Hz tick (1/64 note at 120 BPM)
-#define BPM140INT 26784 // 37.333Hz tick (1/64 note at 140 BPM)
-#define BPM160INT 23436 // 42.667Hz tick (1/64 note at 160 BPM)
+//melody checked at compile time (see MMLvalidator.h)
+#define MELODY "T120 4D4 G2 G8 B8 A8 B8 G2./ G4 A2/ A8/ A8 G8 A8 B4 G4/ G4 D4 G2 G8 B8 A8 B8 G2. B4 A4 5C4 4B4 A4 G4"
+MML_VALIDATE(MELODY);
 
-const char melodycode[] PROGMEM = {"4D4 G2 G8 B8 A8 B8 G2./ G4 A2/ A8/ A8 G8 A8 B4 G4/ G4 D4 G2 G8 B8 A8 B8 G2. B4 A4 5C4 4B4 A4 G4"};
+const char melodycode[] PROGMEM = {MELODY};
 
 MMLtone melody = MMLtone(12, melodycode, sizeof(melodycode));
+MMLcontrol control = MMLcontrol(melody);
 
 
 /****************************************************************************/
@@ -54,39 +56,36 @@ void setup() {
   //setup melody and pin 13 (test led)
   pinMode(LED_BUILTIN, OUTPUT);
   melody.setup();
+#ifdef MMLPROFILE
+  Serial.begin(115200);
+#endif
   
-  //clear TCCR1
-  TCCR1A = 0;
-  TCCR1B = 0;
-
-  //reset counter value +
-  //set compare match register for 32 Hz increments
-  TCNT1  = 0;
-  OCR1A = BPM120CRY;
-
-  // turn on CTC mode
-  // + Set CS12, CS11 and CS10 bits for 8 prescaler
-  // + enable timer compare interrupt
-  TCCR1B |= (1 << WGM12);
-  TCCR1B |= (0 << CS12) | (1 << CS11) | (0 << CS10);
-  TIMSK1 |= (1 << OCIE1A);
+  //timer1 in CTC mode, first interrupt after one tick
+  timer.begin();
 
   //allow interrupts
   sei();
+
+  //have the ISR start the melody on its next tick
+  control.play();
 }
 
 /****************************************************************************/
 /*  I : timer1 comparator vector                                            */
-/*  P : updates the melody at each tick (1/64 note)                         */
+/*  P : updates the melody at each tick (1/MMLRESOLUTION note)              */
 /*  O : /                                                                   */
 /****************************************************************************/
 ISR(TIMER1_COMPA_vect){
-  //timing tests (w/ 16KHz crystal, in microseconds) :
+  //timing tests (w/ 16MHz crystal, in microseconds) :
   //4  <= getNextNote() <= 16
   //20 <=   onTick()    <= 256
-  
-  melody.getNextNote();
-  melody.onTick();
+  //(build with MMLPROFILE to measure them, see MMLprofile.h)
+
+  control.onTick();
+
+  //next interrupt on the next tick, following the T<bpm> commands of the melody
+  timer.setTempo(melody.tempo());
+  timer.schedule(1);
 }
 
 /****************************************************************************/
@@ -95,11 +94,19 @@ ISR(TIMER1_COMPA_vect){
 /*  O : /                                                                   */
 /****************************************************************************/
 void loop() {
-    if(melody.last())
+    //the melody is only handled by the ISR, read its last published status
+    MMLstatus status = control.status();
+
+    if(status.flags & MMLSTS_LAST)
       digitalWrite(LED_BUILTIN, HIGH);
-  
-    if(melody.finished())
-      melody.stop();
-    else
-      melody.start();
+
+#ifdef MMLPROFILE
+    //report the ISR timings once the melody is over (in timer1 counts of 16 us at 16 MHz)
+    static bool reported = false;
+    if((status.flags & MMLSTS_FINISHED) && !reported)
+    {
+      melody.dumpProfile(Serial);
+      reported = true;
+    }
+#endif
 }
@@ -0,0 +1,168 @@
+/*
+ * MMLvalidator.h
+ * -----------------------------------------------
+ * MML code validator.
+ *
+ * MMLtone plays whatever it is given : unknown letters, durations which do not
+ *    divide MMLRESOLUTION (see MMLtempo.h), tokens too long for the note buffer or notes without any octave
+ *    are all played as wrong notes, and a repeated section holding no note only runs
+ *    commands (see MMLrepeat.h). The validator walks through a whole song with the
+ *    rules of MMLtone::decode() and reports the first offending token, its offset in
+ *    the code and the reason (see MMLERR_* in MMLtoken.h).
+ *
+ * It runs at compile time (C++11 constexpr) :
+ *    MML_VALIDATE("4D4 G2 G8 B8 A8 B8 G2./");
+ *    The build fails on an invalid song, the error mentioning MMLinvalid<offset, reason>.
+ *    The song is walked in halves rather than token by token, so that songs of any length
+ *    are checked within the default -fconstexpr-depth of GCC (512).
+ *    Songs compiled with MML_COMPILE are validated automatically.
+ *
+ * The same functions can run on the host (see extras/host/lint.cpp),
+ *    which reports all the offending tokens of a song corpus.
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#ifndef MMLVALIDATOR_H_INCLUDED
+#define MMLVALIDATOR_H_INCLUDED
+
+#include "MMLtoken.h"
+
+#define MMLUNSET 0xFF   //octave not set yet
+
+/****************************************************************
+ * State of the validation after a token                        *
+ ****************************************************************/
+struct MMLlint{
+  unsigned int  offset;     //index of the token checked last
+  unsigned char reason;     //error in that token (see MMLERR_*)
+  unsigned char octave;     //octave in use (MMLUNSET if none yet)
+  unsigned char duration;   //duration in use, in ticks (0 if none yet)
+  unsigned char depth;      //amount of nested sections
+  unsigned char played;     //bit of each section opened set once it holds a note (as MMLrepeats::played)
+
+  constexpr MMLlint(const unsigned int o = 0, const unsigned char r = MMLERR_NONE,
+                    const unsigned char oct = MMLUNSET, const unsigned char dur = 0, const unsigned char d = 0,
+                    const unsigned char p = 0)
+  :offset(o), reason(r), octave(oct), duration(dur), depth(d), played(p)
+  {}
+
+  //state after the token t
+  constexpr MMLlint next(const MMLtoken& t) const{
+    return MMLlint(t.pos, check(t), nextOctave(t), nextDuration(t), nextDepth(t), nextPlayed(t));
+  }
+
+  //state at the end of the code
+  constexpr MMLlint end(const unsigned int size) const{
+    return MMLlint(size, (depth ? MMLERR_UNCLOSED : MMLERR_NONE), octave, duration, depth, played);
+  }
+
+  //whether the innermost section opened holds a note so far (sections nested too deep are reported already)
+  constexpr bool holdsNote() const{
+    return (depth > 8 || (played & (1 << (depth - 1))));
+  }
+
+  //error in the token t, given the tokens before
+  constexpr unsigned char check(const MMLtoken& t) const{
+    return (!t.len ? MMLERR_EMPTY
+          : t.len >= NOTBUFSZ ? MMLERR_LENGTH
+          : t.tempo() ? t.lintTempo()
+          : t.envelope() ? t.lintEnvelope()
+          : t.at(0) == '[' ? (t.len != 1 ? MMLERR_SYNTAX : depth >= MMLLOOPDEPTH ? MMLERR_NESTING : MMLERR_NONE)
+          : t.at(0) == ']' ? (t.lintRepeat() != MMLERR_NONE ? t.lintRepeat() : !depth || !holdsNote() ? MMLERR_REPEAT : MMLERR_NONE)
+          : t.lintNote() != MMLERR_NONE ? t.lintNote()
+          : t.octave(octave) == MMLUNSET ? MMLERR_OCTAVE
+          : !t.duration(duration) ? MMLERR_NODURATION
+          : t.overflow(t.duration(duration)) ? MMLERR_DURATION
+          : t.pitch(t.octave(octave)) > NOTE_B8 ? MMLERR_PITCH
+          : MMLERR_NONE);
+  }
+
+  constexpr unsigned char nextOctave(const MMLtoken& t) const{
+    return (t.command() ? octave : t.octave(octave));
+  }
+
+  constexpr unsigned char nextDuration(const MMLtoken& t) const{
+    return (t.command() ? duration : t.duration(duration));
+  }
+
+  //a section opened holds no note yet, any note goes into all the sections opened
+  constexpr unsigned char nextPlayed(const MMLtoken& t) const{
+    return (t.at(0) == '[' ? (depth < 8 ? (unsigned char)(played & ~(1 << depth)) : played)
+          : t.command() ? played
+          : 0xFF);
+  }
+
+  constexpr unsigned char nextDepth(const MMLtoken& t) const{
+    return (t.at(0) == '[' ? (depth < 0xFF ? depth + 1 : depth)
+          : t.at(0) == ']' && depth ? depth - 1
+          : depth);
+  }
+};
+
+/****************************************************************
+ * Functions walking through an MML string                      *
+ *    (the ranges are split in halves, so that the recursion    *
+ *    depth grows as log2 of the size of the code)              *
+ ****************************************************************/
+struct MMLvalidator{
+  static constexpr bool separator(const char c){
+    return (c == ' ' || c == '\0');
+  }
+
+  //index of the first separator from lo to hi (excluded), hi if none
+  static constexpr unsigned int next(const char* code, const unsigned int lo, const unsigned int hi){
+    return (hi - lo > 1 ? first(code, lo + (hi - lo) / 2, hi, next(code, lo, lo + (hi - lo) / 2))
+          : lo < hi && separator(code[lo]) ? lo
+          : hi);
+  }
+
+  //separator found in the first half, or else the first one of the second half
+  static constexpr unsigned int first(const char* code, const unsigned int mid, const unsigned int hi, const unsigned int found){
+    return (found < mid ? found : next(code, mid, hi));
+  }
+
+  //amount of characters of the token starting at pos, separator excluded
+  static constexpr unsigned int span(const char* code, const unsigned int size, const unsigned int pos){
+    return next(code, pos, size) - pos;
+  }
+
+  //token starting at pos
+  static constexpr MMLtoken token(const char* code, const unsigned int size, const unsigned int pos){
+    return MMLtoken(code, pos, span(code, size, pos));
+  }
+
+  //state after the tokens starting from lo to hi (excluded), each one right after a separator,
+  //  stopping at the first invalid one
+  static constexpr MMLlint walk(const char* code, const unsigned int size, const unsigned int lo, const unsigned int hi, const MMLlint state){
+    return (state.reason != MMLERR_NONE ? state
+          : hi - lo > 1 ? walk(code, size, lo + (hi - lo) / 2, hi, walk(code, size, lo, lo + (hi - lo) / 2, state))
+          : lo < hi && (!lo || separator(code[lo - 1])) ? state.next(token(code, size, lo))
+          : state);
+  }
+
+  //state after the first invalid token, or at the end of the code if none
+  static constexpr MMLlint validate(const char* code, const unsigned int size){
+    return finish(walk(code, size, 0, size, MMLlint()), size);
+  }
+
+  static constexpr MMLlint finish(const MMLlint state, const unsigned int size){
+    return (state.reason != MMLERR_NONE ? state : state.end(size));
+  }
+};
+
+/****************************************************************
+ * Fails the build when instantiated with an error              *
+ ****************************************************************/
+template<unsigned int Offset, unsigned char Reason>
+struct MMLinvalid{
+  static_assert(Reason == MMLERR_NONE, "invalid MML code : see the offset and the reason (MMLERR_*) in MMLinvalid<offset, reason>");
+  static const bool valid = true;
+};
+
+//checks an MML string literal at compile time
+#define MML_VALIDATE(mml) \
+  static_assert(MMLinvalid<MMLvalidator::validate(mml, sizeof(mml)).offset, \
+                           MMLvalidator::validate(mml, sizeof(mml)).reason>::valid, "invalid MML code")
+#endif
@@ -0,0 +1,155 @@
+/*
+ * Arduino.cpp (host shim)
+ * -----------------------------------------------
+ * Stub implementations of the Arduino functions declared in the host Arduino.h
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#include "Arduino.h"
+#include "avr/eeprom.h"
+#include <chrono>
+#include <stdio.h>
+
+unsigned long hostPgmReads = 0;
+void (*hostToneHook)(uint8_t pin, unsigned int frequency) = 0;
+uint8_t hostPinMode[NBPINS] = {0};
+uint8_t hostPinLevel[NBPINS] = {0};
+unsigned int hostPinTone[NBPINS] = {0};
+uint8_t hostEEPROM[EEPROMSZ] = {0};
+HostSerial Serial;
+
+/****************************************************************
+ * I : Pin number                                               *
+ *     Mode of the pin (INPUT or OUTPUT)                        *
+ * P : Record the mode of the pin                               *
+ * O : /                                                        *
+ ****************************************************************/
+void pinMode(uint8_t pin, uint8_t mode){
+  if(pin < NBPINS)
+    hostPinMode[pin] = mode;
+}
+
+/****************************************************************
+ * I : Pin number                                               *
+ *     Level to write (HIGH or LOW)                             *
+ * P : Record the level of the pin                              *
+ * O : /                                                        *
+ ****************************************************************/
+void digitalWrite(uint8_t pin, uint8_t val){
+  if(pin < NBPINS)
+    hostPinLevel[pin] = val;
+}
+
+/****************************************************************
+ * I : Pin number                                               *
+ *     Frequency of the square wave (in Hz)                     *
+ *     Duration (ignored)                                       *
+ * P : Record the frequency played on the pin and call the hook *
+ * O : /                                                        *
+ ****************************************************************/
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration){
+  (void)duration;
+  if(pin < NBPINS)
+    hostPinTone[pin] = frequency;
+  if(hostToneHook)
+    hostToneHook(pin, frequency);
+}
+
+/****************************************************************
+ * I : Pin number                                               *
+ * P : Record the pin as silent and call the hook               *
+ * O : /                                                        *
+ ****************************************************************/
+void noTone(uint8_t pin){
+  if(pin < NBPINS)
+    hostPinTone[pin] = 0;
+  if(hostToneHook)
+    hostToneHook(pin, 0);
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Get the time elapsed since the start of the program      *
+ * O : Time elapsed (in microseconds)                           *
+ ****************************************************************/
+unsigned long micros(){
+  static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Get the time elapsed since the start of the program      *
+ * O : Time elapsed (in milliseconds)                           *
+ ****************************************************************/
+unsigned long millis(){
+  return micros() / 1000;
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Read the CPU timestamp counter (steady clock in          *
+ *     nanoseconds on other architectures)                      *
+ * O : Clock counts                                             *
+ ****************************************************************/
+uint32_t hostCycles(){
+#if defined(__x86_64__) || defined(__i386__)
+  return (uint32_t)__builtin_ia32_rdtsc();
+#else
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/****************************************************************
+ * I : String to print                                          *
+ * P : Write a string                                           *
+ * O : Amount of bytes written                                  *
+ ****************************************************************/
+size_t Print::print(const char* str){
+  size_t n = 0;
+  while(*str)
+    n += this->write((uint8_t)*str++);
+  return n;
+}
+
+/****************************************************************
+ * I : Number to print                                          *
+ * P : Write a number in decimal                                *
+ * O : Amount of bytes written                                  *
+ ****************************************************************/
+size_t Print::print(unsigned long n){
+  char digits[24];
+  snprintf(digits, sizeof(digits), "%lu", n);
+  return this->print(digits);
+}
+
+/****************************************************************
+ * I : String to print                                          *
+ * P : Write a string and a line break                          *
+ * O : Amount of bytes written                                  *
+ ****************************************************************/
+size_t Print::println(const char* str){
+  size_t n = this->print(str);
+  return n + this->print("\r\n");
+}
+
+/****************************************************************
+ * I : Number to print                                          *
+ * P : Write a number in decimal and a line break               *
+ * O : Amount of bytes written                                  *
+ ****************************************************************/
+size_t Print::println(unsigned long n){
+  size_t written = this->print(n);
+  return written + this->print("\r\n");
+}
+
+/****************************************************************
+ * I : Byte to write                                            *
+ * P : Write a byte to the standard output                      *
+ * O : Amount of bytes written                                  *
+ ****************************************************************/
+size_t HostSerial::write(uint8_t c){
+  return (fputc(c, stdout) == EOF ? 0 : 1);
+}
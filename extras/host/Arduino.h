@@ -0,0 +1,101 @@
+/*
+ * Arduino.h (host shim)
+ * -----------------------------------------------
+ * Minimal stand-in for the Arduino core, used to build the MMLtone library
+ *    on a Linux host (benchmarks, renderers and other tools in extras/host).
+ *
+ * Only what the library actually uses is provided :
+ * - pinMode(), digitalWrite(), tone() and noTone() are stubs which only record
+ *   the state of each pin. A hook can be set to be informed of every tone change.
+ * - PROGMEM is ignored and the pgm_read_*() macros are plain memory reads,
+ *   which count the bytes read (hostPgmReads, reported by bench.cpp).
+ * - cli() and sei() do nothing, as there are no interrupts on the host.
+ * - Print and Stream only hold the methods used by the library, and Serial
+ *   writes to the standard output.
+ * - The profiling clock (see MMLprofile.h) is the CPU timestamp counter.
+ * - The EEPROM (see avr/eeprom.h) is an array in RAM.
+ *
+ * Add -Iextras/host to the compiler flags so that <Arduino.h> resolves here.
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#ifndef HOST_ARDUINO_H_INCLUDED
+#define HOST_ARDUINO_H_INCLUDED
+
+#include <stdint.h>
+#include <ctype.h>
+#include <string.h>
+#include <stddef.h>
+
+#define HIGH          1
+#define LOW           0
+#define INPUT         0
+#define OUTPUT        1
+#define LED_BUILTIN   13
+#define NBPINS        20
+
+#define PROGMEM
+#define pgm_read_byte_near(addr)  (hostPgmReads++, *(const uint8_t*)(addr))
+#define pgm_read_word_near(addr)  (hostPgmReads += 2, *(const uint16_t*)(addr))
+#define memcpy_P(dst, src, len)   (hostPgmReads += (len), memcpy((dst), (src), (len)))
+
+#define cli()
+#define sei()
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+//amount of bytes read from PROGMEM so far
+extern unsigned long hostPgmReads;
+
+//hook called on each tone() (frequency > 0) and noTone() (frequency = 0)
+extern void (*hostToneHook)(uint8_t pin, unsigned int frequency);
+
+//state of the pins, as set by the stubs
+extern uint8_t hostPinMode[NBPINS];
+extern uint8_t hostPinLevel[NBPINS];
+extern unsigned int hostPinTone[NBPINS];
+
+class Print
+{
+  public:
+      virtual ~Print(){}
+      virtual size_t write(uint8_t c) = 0;
+      size_t print(const char* str);
+      size_t print(unsigned long n);
+      size_t println(const char* str = "");
+      size_t println(unsigned long n);
+};
+
+class Stream : public Print
+{
+  public:
+      virtual int available() = 0;
+      virtual int read() = 0;
+};
+
+//serial port writing to the standard output
+class HostSerial : public Stream
+{
+  public:
+      void begin(unsigned long baud){ (void)baud; }
+      size_t write(uint8_t c);
+      int available(){ return 0; }
+      int read(){ return -1; }
+};
+extern HostSerial Serial;
+
+//profiling clock (see MMLprofile.h) : CPU timestamp counter
+#define MMLPROFILE_CLOCK()  hostCycles()
+#define MMLHISTOSHIFT       6
+uint32_t hostCycles();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration = 0);
+void noTone(uint8_t pin);
+unsigned long micros();
+unsigned long millis();
+#endif
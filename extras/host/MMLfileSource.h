@@ -0,0 +1,92 @@
+/*
+ * MMLfileSource.h
+ * -----------------------------------------------
+ * MMLsource reading the MML code from a file on the host, so that songs of any
+ *    length can be played by the host tools without being loaded in memory.
+ *
+ * Line breaks and tabulations in the file are read as spaces.
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#ifndef MMLFILESOURCE_H_INCLUDED
+#define MMLFILESOURCE_H_INCLUDED
+
+#include "MMLsource.h"
+#include <stdio.h>
+
+class MMLfileSource : public MMLsource
+{
+  private:
+      FILE*           m_file;               //file holding the MML code
+      unsigned int    m_size;               //size (in bytes) of the whole MML code
+
+  public:
+      MMLfileSource()
+      :m_file(NULL), m_size(0)
+      {}
+
+      ~MMLfileSource(){
+        if(this->m_file)
+          fclose(this->m_file);
+      }
+
+      //open the file holding the MML code (true if opened)
+      bool open(const char* path){
+        this->m_file = fopen(path, "rb");
+        if(!this->m_file)
+          return false;
+
+        //trailing line breaks and spaces are not part of the song
+        fseek(this->m_file, 0, SEEK_END);
+        long siz = ftell(this->m_file);
+        while(siz > 0)
+        {
+          fseek(this->m_file, siz - 1, SEEK_SET);
+          int c = fgetc(this->m_file);
+          if(c != ' ' && c != '\n' && c != '\r' && c != '\t')
+            break;
+          siz--;
+        }
+        if(siz > 0xFFFF)
+          return false;
+
+        this->m_size = (unsigned int)siz;
+        return true;
+      }
+
+      //size of the MML code
+      unsigned int size(){
+        return this->m_size;
+      }
+
+      //copy the note starting at pos, followed by a '\0' (amount of bytes read returned)
+      unsigned char fetch(const unsigned int pos, char* buffer, const unsigned char max){
+        unsigned char i = 0;
+        unsigned int p = pos;
+
+        fseek(this->m_file, pos, SEEK_SET);
+        while(p < this->m_size)
+        {
+          int c = fgetc(this->m_file);
+          if(c == EOF)
+            break;
+          if(c == '\n' || c == '\r' || c == '\t')
+            c = ' ';
+
+          if(c == ' ' || c == '\0')
+          {
+            p++;
+            break;
+          }
+          if(i >= max)
+            break;
+          buffer[i++] = (char)c;
+          p++;
+        }
+        buffer[i] = '\0';
+        return p - pos;
+      }
+};
+#endif
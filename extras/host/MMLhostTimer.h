@@ -0,0 +1,54 @@
+/*
+ * MMLhostTimer.h
+ * -----------------------------------------------
+ * MMLtimer standing in for a hardware timer in the host tools.
+ *
+ * Nothing fires by itself : the tool calls MMLsequencer::onTimer() in a loop,
+ *    advancing its own clock by the amount of ticks last scheduled.
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#ifndef MMLHOSTTIMER_H_INCLUDED
+#define MMLHOSTTIMER_H_INCLUDED
+
+#include "MMLtimer.h"
+
+class MMLhostTimer : public MMLtimer
+{
+  private:
+      unsigned char   m_max;                //maximum amount of ticks between two interrupts
+      unsigned char   m_scheduled;          //amount of ticks until the next interrupt
+      unsigned int    m_bpm;                //tempo (in beats per minute)
+
+  public:
+      //timer allowing at most maximum ticks between two interrupts
+      //  (33 matches timer1 at 120 BPM)
+      MMLhostTimer(const unsigned char maximum = 33)
+      :m_max(maximum), m_scheduled(1), m_bpm(120)
+      {}
+
+      unsigned char maxTicks(){
+        return this->m_max;
+      }
+
+      void schedule(const unsigned char ticks){
+        this->m_scheduled = ticks;
+      }
+
+      void setTempo(const unsigned int bpm){
+        this->m_bpm = bpm;
+      }
+
+      //tempo last set by the sequencer
+      unsigned int tempo(){
+        return this->m_bpm;
+      }
+
+      //amount of ticks until the next interrupt
+      unsigned char scheduled(){
+        return this->m_scheduled;
+      }
+};
+#endif
@@ -0,0 +1,131 @@
+/*
+ * MMLpacker.h
+ * -----------------------------------------------
+ * Packer of songs on the host (see MMLpacked.h), shared by the host tools.
+ *
+ * The MML code is compiled into events at run time, with the rules of MMLcompiler.h,
+ *    then each event is packed in its shortest token, given the previous pitch and the
+ *    duration in use. Whichever token holds a note, the previous pitch becomes its pitch,
+ *    and a dotted token keeps the duration in use where a 3 bytes one would replace it :
+ *    no shorter token can make the next ones longer, and the song is packed in as few
+ *    bytes as the format allows.
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#ifndef MMLPACKER_H_INCLUDED
+#define MMLPACKER_H_INCLUDED
+
+#include "MMLcompiler.h"
+#include "MMLpacked.h"
+#include <vector>
+
+#define MMLPCK_DURATIONS  6     //amount of duration codes of a whole note down (MMLPCK_WHOLE to 7)
+
+/****************************************************************
+ * I : MML code                                                 *
+ *     Size of the code (sizeof())                              *
+ * O : Events played by MMLtone (same as MML_COMPILE)           *
+ ****************************************************************/
+inline std::vector<uint16_t> MMLcompile(const char* code, const unsigned int size){
+  std::vector<uint16_t> events;
+  unsigned char octave = 0, duration = MMLDEFTICKS;
+  for(unsigned int pos = 0 ; pos < size ; )
+  {
+    const unsigned int length = MMLcompiler::length(code, size, pos);
+    const MMLtoken token(code, pos, length);
+    events.push_back(token.event(octave, duration));
+    octave = token.octave(octave);
+    duration = token.duration(duration);
+    pos += length;
+  }
+  return events;
+}
+
+/****************************************************************
+ * I : Events (see MMLEVT_* in MMLtone.h)                       *
+ *     Amount of events                                         *
+ * O : Packed song (see MMLpacked.h)                            *
+ ****************************************************************/
+inline std::vector<uint8_t> MMLpack(const uint16_t* events, const unsigned int count){
+  std::vector<uint8_t> packed;
+  unsigned char pitch = 0, duration = MMLDEFTICKS;
+
+  for(unsigned int i = 0 ; i < count ; i++)
+  {
+    const uint16_t e = events[i];
+    const unsigned char note = e & MMLEVT_PITCH;
+    const unsigned int arg = e >> MMLEVT_TSHIFT;
+
+    //commands
+    switch(note){
+      case MMLEVT_TEMPO:
+          packed.push_back(MMLPCK_EXT | ((arg > 0xFF ? MMLPCK_XTEMPOH : MMLPCK_XTEMPO) << MMLPCK_DSHIFT));
+          packed.push_back(arg & 0xFF);
+          continue;
+
+      case MMLEVT_LOOP:
+          packed.push_back(MMLPCK_EXT | (MMLPCK_XLOOP << MMLPCK_DSHIFT));
+          continue;
+
+      case MMLEVT_REPEAT:
+          packed.push_back(MMLPCK_EXT | (MMLPCK_XREPEAT << MMLPCK_DSHIFT));
+          packed.push_back(arg);
+          continue;
+
+      case MMLEVT_ENVELOPE + MMLENV_ATTACK:
+      case MMLEVT_ENVELOPE + MMLENV_DECAY:
+      case MMLEVT_ENVELOPE + MMLENV_SUSTAIN:
+      case MMLEVT_ENVELOPE + MMLENV_RELEASE:
+          packed.push_back(MMLPCK_EXT | ((MMLPCK_XENVELOPE + note - MMLEVT_ENVELOPE) << MMLPCK_DSHIFT));
+          packed.push_back(arg);
+          continue;
+
+      default:
+          break;
+    }
+
+    //duration code, if any
+    const unsigned char ticks = (e & MMLEVT_TICKS) >> MMLEVT_TSHIFT;
+    const bool cut = (e & MMLEVT_CUT);
+    int code = -1;
+    if(ticks == duration)
+      code = MMLPCK_STICKY;
+    else if(ticks == (duration + (duration >> 1) > 0xFF ? 0xFF : duration + (duration >> 1)))
+      code = MMLPCK_DOTTED;
+    for(unsigned char d = 0 ; code < 0 && d < MMLPCK_DURATIONS ; d++)
+    {
+      if(ticks == (MMLRESOLUTION >> d))
+        code = MMLPCK_WHOLE + d;
+    }
+
+    //note of any duration
+    if(code < 0)
+    {
+      packed.push_back(MMLPCK_EXT | (MMLPCK_XNOTE << MMLPCK_DSHIFT));
+      packed.push_back((note > NOTE_B8 ? MMLEVT_PITCH : note) | (cut ? MMLPCK_CUT : 0));
+      packed.push_back(ticks);
+      duration = ticks;
+    }
+    else
+    {
+      //pitch code
+      const int delta = (int)note - pitch;
+      const unsigned char p = (note > NOTE_B8 ? MMLPCK_REST
+                              : delta >= -MMLPCK_SAME && delta <= MMLPCK_SAME ? delta + MMLPCK_SAME
+                              : MMLPCK_ABS);
+
+      packed.push_back((cut ? MMLPCK_CUT : 0) | (code << MMLPCK_DSHIFT) | p);
+      if(p == MMLPCK_ABS)
+        packed.push_back(note);
+      if(code >= MMLPCK_WHOLE)
+        duration = ticks;
+    }
+
+    if(note <= NOTE_B8)
+      pitch = note;
+  }
+  return packed;
+}
+#endif
@@ -0,0 +1,80 @@
+/*
+ * MMLrecordOutput.h
+ * -----------------------------------------------
+ * MMLoutput recording every call in the host tools, instead of producing a signal.
+ *
+ * Each call is stored with the tick set last by the tool (setTick()), so that
+ *    a whole song can be compared with the calls expected, note by note.
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#ifndef MMLRECORDOUTPUT_H_INCLUDED
+#define MMLRECORDOUTPUT_H_INCLUDED
+
+#include "MMLoutput.h"
+#include <vector>
+
+#define MMLREC_BEGIN  0         //begin() called
+#define MMLREC_PLAY   1         //play() called
+#define MMLREC_MUTE   2         //mute() called
+#define MMLREC_VOLUME 3         //volume() called
+#define MMLREC_ENVELOPE 4       //envelope() called
+
+//call made to the output
+typedef struct{
+  unsigned long   tick;         //tick during which the call has been made
+  unsigned char   type;         //call made (see MMLREC_*)
+  unsigned char   pin;          //pin given
+  unsigned char   note;         //note given (play()), volume (volume()) or parameter (envelope())
+  uint16_t        value;        //value given (envelope()), or ratio of the detune (play())
+}MMLrecord;
+
+class MMLrecordOutput : public MMLoutput
+{
+  private:
+      std::vector<MMLrecord> m_records;   //calls made so far
+      unsigned long   m_tick;               //tick given to the next calls
+
+  public:
+      MMLrecordOutput()
+      :m_tick(0)
+      {}
+
+      void begin(const unsigned char pin){
+        this->m_records.push_back({this->m_tick, MMLREC_BEGIN, pin, 0, 0});
+      }
+
+      void play(const unsigned char pin, const unsigned char note, const uint16_t ratio){
+        this->m_records.push_back({this->m_tick, MMLREC_PLAY, pin, note, ratio});
+      }
+
+      void mute(const unsigned char pin){
+        this->m_records.push_back({this->m_tick, MMLREC_MUTE, pin, 0, 0});
+      }
+
+      void volume(const unsigned char pin, const unsigned char level){
+        this->m_records.push_back({this->m_tick, MMLREC_VOLUME, pin, level, 0});
+      }
+
+      void envelope(const unsigned char pin, const unsigned char param, const unsigned char value){
+        this->m_records.push_back({this->m_tick, MMLREC_ENVELOPE, pin, param, value});
+      }
+
+      //tick during which the next calls are made
+      void setTick(const unsigned long tick){
+        this->m_tick = tick;
+      }
+
+      //calls made so far
+      const std::vector<MMLrecord>& records() const{
+        return this->m_records;
+      }
+
+      //forget the calls made so far
+      void clear(){
+        this->m_records.clear();
+      }
+};
+#endif
@@ -0,0 +1,20 @@
+/*
+ * avr/eeprom.h (host shim)
+ * -----------------------------------------------
+ * EEPROM emulated by an array in RAM, which the host tools fill as they see fit
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#ifndef HOST_EEPROM_H_INCLUDED
+#define HOST_EEPROM_H_INCLUDED
+
+#include <stdint.h>
+
+#define EEPROMSZ 1024   //size of the ATmega328p EEPROM
+
+extern uint8_t hostEEPROM[EEPROMSZ];
+
+#define eeprom_read_byte(addr)  (hostEEPROM[(uintptr_t)(addr) % EEPROMSZ])
+#endif
@@ -0,0 +1,342 @@
+/*
+ * bench.cpp
+ * -----------------------------------------------
+ * Host microbenchmark of the MMLtone decoder.
+ *
+ * Each song of the corpus (songs.h) is played from start to finish a number
+ *    of times, calling getNextNote() then onTick() exactly as the timer ISR does.
+ * Songs are played three times : from their MML code, from their pre-decoded
+ *    events (see MMLcompiler.h), then from their packed tokens (see MMLpacked.h).
+ * Their throughput is then compared with MMLstaticTone (see MMLstaticTone.h).
+ * Finally, the first songs are played together as the voices of an MMLsequencer,
+ *    timing each call to MMLsequencer::onTick(), then each call to MMLsequencer::onTimer()
+ *    in tickless mode (along with the amount of interrupts it saves).
+ * Three measurements are made :
+ * - the latency of each call, timed individually, reported as a distribution
+ *   (min, median, 90th and 99th percentiles, max and mean, in nanoseconds)
+ * - the amount of bytes each call reads from PROGMEM (song and pitch table), as a distribution :
+ *   unlike the latency, it does not depend on the host, and bounds the work done on each tick
+ * - the throughput (ticks per second), measured on untimed passes
+ *
+ * Build (from the repository root) :
+ *    g++ -O2 -std=gnu++11 -I. -Iextras/host *.cpp extras/host/Arduino.cpp extras/host/bench.cpp -o mmlbench
+ *    (add -DMMLPROFILE to also print the counters kept by the library, in CPU cycles)
+ *
+ * Usage :
+ *    ./mmlbench [passes]
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#include "MMLtone.h"
+#include "MMLsequencer.h"
+#include "MMLhostTimer.h"
+#include "MMLstaticTone.h"
+#include "MMLpacker.h"
+#include "songs.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#define BENCHPIN 12
+
+//ways of playing a song
+#define MODE_CODE     0         //MML code
+#define MODE_EVENTS   1         //pre-decoded events
+#define MODE_PACKED   2         //packed tokens
+#define NBMODES       3
+
+static std::vector<uint8_t> packed[NBSONGS];   //songs packed at startup
+
+typedef std::chrono::steady_clock benchclock;
+
+#ifdef MMLPROFILE
+static MMLprofile tickProfile, fetchProfile;    //counters of the last song measured
+#endif
+
+/****************************************************************
+ * I : Duration between two clock readings                      *
+ * P : Convert a clock duration to nanoseconds                  *
+ * O : Amount of nanoseconds                                    *
+ ****************************************************************/
+static unsigned long toNanos(const benchclock::duration d){
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+}
+
+/****************************************************************
+ * I : Label of the distribution                                *
+ *     Latency samples (sorted in place)                        *
+ * P : Print the latency distribution of a method               *
+ * O : /                                                        *
+ ****************************************************************/
+static void printDistribution(const char* label, std::vector<unsigned long>& samples){
+  if(samples.empty())
+    return;
+
+  std::sort(samples.begin(), samples.end());
+  unsigned long long sum = 0;
+  for(size_t i = 0 ; i < samples.size() ; i++)
+    sum += samples[i];
+
+  const size_t n = samples.size();
+  printf("  %-12s n=%-8zu min=%-6lu p50=%-6lu p90=%-6lu p99=%-6lu max=%-8lu mean=%.1f\n",
+         label, n, samples[0], samples[n / 2], samples[(n * 9) / 10], samples[(n * 99) / 100],
+         samples[n - 1], (double)sum / n);
+}
+
+/****************************************************************
+ * I : Index of the song to play                                *
+ *     Way of playing it (MODE_*)                               *
+ * P : Build and start a melody playing the song                *
+ * O : Melody                                                   *
+ ****************************************************************/
+static MMLtone load(const unsigned int s, const unsigned char mode){
+  MMLtone melody = (mode == MODE_PACKED ? MMLtone(BENCHPIN, packed[s].data(), packed[s].size())
+                    : mode == MODE_EVENTS ? MMLtone(BENCHPIN, songs[s].events, songs[s].count)
+                    : MMLtone(BENCHPIN, songs[s].code, songs[s].size));
+  melody.setup();
+  melody.start();
+  return melody;
+}
+
+/****************************************************************
+ * I : Melody to rewind                                         *
+ * P : Stop the melody and rewind it to its first note          *
+ * O : /                                                        *
+ ****************************************************************/
+static void rewind(MMLtone& melody){
+  melody.stop();
+  melody.reset();
+  melody.start();
+}
+
+/****************************************************************
+ * I : Index of the song to benchmark                           *
+ *     Way of playing it (MODE_*)                               *
+ *     Amount of times the song is to be played                 *
+ *     Vectors receiving the latency samples                    *
+ *     Vectors receiving the bytes read by each call            *
+ * P : Play a song while timing each call to the decoder        *
+ * O : /                                                        *
+ ****************************************************************/
+static void measureLatency(const unsigned int s, const unsigned char mode, const unsigned int passes,
+                           std::vector<unsigned long>& nextnote, std::vector<unsigned long>& ontick,
+                           std::vector<unsigned long>& nextreads, std::vector<unsigned long>& tickreads){
+  MMLtone melody = load(s, mode);
+
+  for(unsigned int p = 0 ; p < passes ; p++)
+  {
+    while(!melody.finished())
+    {
+      const unsigned long r0 = hostPgmReads;
+      benchclock::time_point t0 = benchclock::now();
+      melody.getNextNote();
+      benchclock::time_point t1 = benchclock::now();
+      const unsigned long r1 = hostPgmReads;
+      melody.onTick();
+      benchclock::time_point t2 = benchclock::now();
+
+      nextnote.push_back(toNanos(t1 - t0));
+      ontick.push_back(toNanos(t2 - t1));
+      nextreads.push_back(r1 - r0);
+      tickreads.push_back(hostPgmReads - r1);
+    }
+    rewind(melody);
+  }
+
+#ifdef MMLPROFILE
+  //keep the counters of the instrumented library (see MMLprofile.h)
+  tickProfile = melody.tickProfile();
+  fetchProfile = melody.fetchProfile();
+#endif
+}
+
+/****************************************************************
+ * I : Index of the song to benchmark                           *
+ *     Way of playing it (MODE_*)                               *
+ *     Amount of times the song is to be played                 *
+ *     Variable receiving the amount of ticks processed         *
+ * P : Play a song as fast as possible without timing each call *
+ * O : Time elapsed (in nanoseconds)                            *
+ ****************************************************************/
+static unsigned long measureThroughput(const unsigned int s, const unsigned char mode, const unsigned int passes, unsigned long long& ticks){
+  MMLtone melody = load(s, mode);
+
+  benchclock::time_point start = benchclock::now();
+  for(unsigned int p = 0 ; p < passes ; p++)
+  {
+    while(!melody.finished())
+    {
+      melody.getNextNote();
+      melody.onTick();
+      ticks++;
+    }
+    rewind(melody);
+  }
+  return toNanos(benchclock::now() - start);
+}
+
+/****************************************************************
+ * I : Melody fixed at compile time                             *
+ *     Amount of times the song is to be played                 *
+ *     Variable receiving the amount of ticks processed         *
+ * P : Play a song as fast as possible without timing each call *
+ * O : Time elapsed (in nanoseconds)                            *
+ ****************************************************************/
+template<class Melody>
+static unsigned long measureStatic(Melody& melody, const unsigned int passes, unsigned long long& ticks){
+  melody.setup();
+  melody.start();
+
+  benchclock::time_point start = benchclock::now();
+  for(unsigned int p = 0 ; p < passes ; p++)
+  {
+    while(!melody.finished())
+    {
+      melody.getNextNote();
+      melody.onTick();
+      ticks++;
+    }
+    melody.stop();
+    melody.reset();
+    melody.start();
+  }
+  return toNanos(benchclock::now() - start);
+}
+
+/****************************************************************
+ * I : Amount of times the songs are to be played               *
+ * P : Play the first songs simultaneously with a sequencer     *
+ *     while timing each tick                                   *
+ * O : /                                                        *
+ ****************************************************************/
+static void measureSequencer(const unsigned int passes){
+  std::vector<MMLtone> voices;
+  std::vector<unsigned long> ontick;
+  MMLsequencer sequencer;
+
+  for(unsigned int s = 0 ; s < NBSONGS && s < MAXVOICES ; s++)
+    voices.push_back(MMLtone(BENCHPIN + s, songs[s].events, songs[s].count));
+  for(unsigned int v = 0 ; v < voices.size() ; v++)
+    sequencer.add(voices[v]);
+  sequencer.setup();
+
+  for(unsigned int p = 0 ; p < passes ; p++)
+  {
+    sequencer.reset();
+    sequencer.start();
+    while(!sequencer.finished())
+    {
+      benchclock::time_point t0 = benchclock::now();
+      sequencer.onTick();
+      ontick.push_back(toNanos(benchclock::now() - t0));
+    }
+    sequencer.stop();
+  }
+
+  //same songs in tickless mode
+  std::vector<unsigned long> ontimer;
+  for(unsigned int p = 0 ; p < passes ; p++)
+  {
+    MMLhostTimer timer;
+    sequencer.reset();
+    sequencer.start();
+    while(!sequencer.finished())
+    {
+      benchclock::time_point t0 = benchclock::now();
+      sequencer.onTimer(timer);
+      ontimer.push_back(toNanos(benchclock::now() - t0));
+    }
+    sequencer.stop();
+  }
+
+  printf("\n=== sequencer (%zu voices, pre-decoded events) ===\n\n", voices.size());
+  printDistribution("onTick", ontick);
+  printDistribution("onTimer", ontimer);
+  printf("  %-12s %zu interrupts instead of %zu ticks\n", "tickless", ontimer.size() / passes, ontick.size() / passes);
+}
+
+int main(int argc, char* argv[]){
+  const unsigned int passes = (argc > 1 ? (unsigned int)atoi(argv[1]) : 2000);
+  const char* modes[NBMODES] = {"MML code", "pre-decoded events", "packed tokens"};
+
+  for(unsigned int s = 0 ; s < NBSONGS ; s++)
+    packed[s] = MMLpack(songs[s].events, songs[s].count);
+
+  printf("MMLtone host benchmark (%u passes per song, latencies in ns)\n", passes);
+
+  for(unsigned char m = 0 ; m < NBMODES ; m++)
+  {
+    std::vector<unsigned long> allnext, alltick, allnextreads, alltickreads;
+    unsigned long long alltickcount = 0, allnanos = 0;
+
+    printf("\n=== %s ===\n\n", modes[m]);
+    for(unsigned int s = 0 ; s < NBSONGS ; s++)
+    {
+      std::vector<unsigned long> nextnote, ontick, nextreads, tickreads;
+      unsigned long long ticks = 0;
+
+      measureLatency(s, m, passes, nextnote, ontick, nextreads, tickreads);
+      const unsigned long nanos = measureThroughput(s, m, passes, ticks);
+      const unsigned int bytes = (m == MODE_PACKED ? packed[s].size() : m == MODE_EVENTS ? songs[s].count * 2 : songs[s].size);
+
+      printf("%s (%u bytes, %llu ticks per pass)\n", songs[s].name, bytes, ticks / passes);
+      printDistribution("getNextNote", nextnote);
+      printDistribution("onTick", ontick);
+      printDistribution("next (bytes)", nextreads);
+      printDistribution("tick (bytes)", tickreads);
+      printf("  %-12s %.0f ticks/s\n", "throughput", ticks * 1e9 / nanos);
+#ifdef MMLPROFILE
+      tickProfile.dump(Serial, "  onTick (cycles)");
+      fetchProfile.dump(Serial, "  getNextNote (cycles)");
+#endif
+      printf("\n");
+
+      allnext.insert(allnext.end(), nextnote.begin(), nextnote.end());
+      alltick.insert(alltick.end(), ontick.begin(), ontick.end());
+      allnextreads.insert(allnextreads.end(), nextreads.begin(), nextreads.end());
+      alltickreads.insert(alltickreads.end(), tickreads.begin(), tickreads.end());
+      alltickcount += ticks;
+      allnanos += nanos;
+    }
+
+    printf("all songs\n");
+    printDistribution("getNextNote", allnext);
+    printDistribution("onTick", alltick);
+    printDistribution("next (bytes)", allnextreads);
+    printDistribution("tick (bytes)", alltickreads);
+    printf("  %-12s %.0f ticks/s\n", "throughput", alltickcount * 1e9 / allnanos);
+  }
+
+  //same songs, everything fixed at compile time
+  printf("\n=== MMLstaticTone ===\n\n");
+  for(unsigned int s = 0 ; s < NBSONGS ; s++)
+  {
+    unsigned long long ticks = 0, eventticks = 0, packedticks = 0;
+    MMLstaticTone<BENCHPIN> code = MMLstaticTone<BENCHPIN>(MMLprogmemSource(songs[s].code, songs[s].size));
+    MMLstaticTone<BENCHPIN, MMLeventSource> events = MMLstaticTone<BENCHPIN, MMLeventSource>(MMLeventSource(songs[s].events, songs[s].count));
+    MMLstaticTone<BENCHPIN, MMLpackedSource> tokens = MMLstaticTone<BENCHPIN, MMLpackedSource>(MMLpackedSource(packed[s].data(), packed[s].size()));
+    const unsigned long nanos = measureStatic(code, passes, ticks);
+    const unsigned long eventnanos = measureStatic(events, passes, eventticks);
+    const unsigned long packednanos = measureStatic(tokens, passes, packedticks);
+
+    printf("%-8s %-12s %.0f ticks/s (MML code), %.0f ticks/s (pre-decoded events), %.0f ticks/s (packed tokens)\n",
+           songs[s].name, "throughput", ticks * 1e9 / nanos, eventticks * 1e9 / eventnanos, packedticks * 1e9 / packednanos);
+  }
+
+  measureSequencer(passes);
+
+  //RAM kept by each voice (on this host : AVR pointers and indexes are half the size)
+  printf("\n=== footprint per voice ===\n\n");
+  printf("%-40s %3zu bytes (budget %zu)\n", "MMLtone", sizeof(MMLtone), (size_t)MMLVOICEBUDGET);
+  printf("%-40s %3zu bytes (budget %zu)\n", "MMLstaticTone (MML code)", sizeof(MMLstaticTone<BENCHPIN>),
+         (size_t)MMLSTATICBUDGET + sizeof(MMLprogmemSource) + sizeof(MMLtoneOutput));
+  printf("%-40s %3zu bytes (budget %zu)\n", "MMLstaticTone (pre-decoded events)", sizeof(MMLstaticTone<BENCHPIN, MMLeventSource>),
+         (size_t)MMLSTATICBUDGET + sizeof(MMLeventSource) + sizeof(MMLtoneOutput));
+  printf("%-40s %3zu bytes (budget %zu)\n", "MMLstaticTone (packed tokens)", sizeof(MMLstaticTone<BENCHPIN, MMLpackedSource>),
+         (size_t)MMLSTATICBUDGET + sizeof(MMLpackedSource) + sizeof(MMLtoneOutput));
+  return 0;
+}
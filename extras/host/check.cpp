@@ -0,0 +1,846 @@
+/*
+ * check.cpp
+ * -----------------------------------------------
+ * Checks of the code shared between loop() and the timer ISR, which the fuzzer
+ *    and the golden traces do not reach (they play whole songs from PROGMEM).
+ *
+ * - MMLstreamSource starved in the middle of a song : the stream stops delivering at
+ *   each byte of the song in turn (in the middle of a note as well), then resumes a few
+ *   ticks later. The melody (MMLtone, then MMLstaticTone) must hold, then play exactly
+ *   the tone changes of the song read from PROGMEM, the ones after the stall being
+ *   delayed by the same amount of ticks, and only finish once the whole song has been read.
+ * - MMLtimerPeriod (timer1 at 16 MHz) at the lowest tempos : the tempo is clamped to the
+ *   slowest one whose tick fits in 16 bits, a period spans at least one tick, the counts
+ *   of a period fit in 16 bits and add up without drift. A song at T1 played in tickless mode
+ *   (MMLsequencer::onTimer()) must change its tones on the same ticks as on every tick.
+ * - Seeks back before the first tempo change of a song, without then with an index, once
+ *   the tempo has been set with setTempo() : the default tempo (MMLDEFTEMPO) must be restored,
+ *   and the tempo changed after, as a rewind (reset()) does.
+ * - Songs running many commands between two notes : sections without any note must be
+ *   played once (not 255^3 times), and no tick may run more than MMLMAXCOMMANDS commands,
+ *   the following ones delaying the next note, with MMLtone and MMLstaticTone alike.
+ * - Two voices sharing the default output, one of them detuned : the other one must play
+ *   the song in tune, and the detuned one the same tones shifted by its ratio only.
+ * - MMLcontrol : a full queue refuses the next command, the commands are executed in order
+ *   on the next tick and the status published is the one of a melody driven directly,
+ *   over thousands of commands (the ring indexes wrap around). The ISR is then run from
+ *   a timer signal interrupting loop() at any instruction, as on the AVR : every status
+ *   read while the ticks run must be one the ISR published, never a torn one.
+ *
+ * Build (from the repository root) :
+ *    g++ -g -O1 -std=gnu++11 -fsanitize=address,undefined -I. -Iextras/host *.cpp extras/host/Arduino.cpp extras/host/check.cpp -o mmlcheck
+ *
+ * Usage (from the repository root) :
+ *    ./mmlcheck
+ *    The result of each check is printed, and the exit status is 0 if all of them pass, 1 otherwise.
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#include "MMLtone.h"
+#include "MMLstaticTone.h"
+#include "MMLsequencer.h"
+#include "MMLtimer.h"
+#include "MMLcontrol.h"
+#include "songs.h"
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <set>
+#include <signal.h>
+#include <sys/time.h>
+
+#define MAXTICKS  100000    //ticks after which a song is considered endless
+#define CHECKPIN  12
+#define STALL     12        //ticks during which the stream is starved, from the point the song reaches the byte
+#define REFILLS   2         //ticks after which refill() has handed over a whole buffer, once the stream resumes
+#define ROUNDS    1000      //rounds of commands posted to MMLcontrol (each filling the queue)
+#define PLAYS     2000      //times the song is played again by loop() while the ISR interrupts it
+#define PERIOD    20        //period of the timer signal (in microseconds)
+#define TIMERCOUNTS 3750000UL //timer1 counts per minute over 4 at 16 MHz (see MMLTIMER1COUNTS)
+
+typedef struct{
+  unsigned long   tick;     //tick at which the tone changed
+  unsigned int    frequency;//frequency played (0 for noTone())
+}record_t;
+
+static std::vector<record_t>* trace = 0;
+static unsigned long tick = 0;
+static unsigned int failures = 0;
+
+/****************************************************************
+ * I : Pin of the tone                                          *
+ *     Frequency played (0 for noTone())                        *
+ * P : Record a tone change in the current trace                *
+ * O : /                                                        *
+ ****************************************************************/
+static void record(uint8_t pin, unsigned int frequency){
+  (void)pin;
+  if(trace)
+    trace->push_back({tick, frequency});
+}
+
+/****************************************************************
+ * I : Name of the check                                        *
+ *     Result of the check                                      *
+ *     Details printed if it failed                             *
+ * P : Print the result of a check, and count the failures      *
+ * O : /                                                        *
+ ****************************************************************/
+static void report(const char* name, const bool ok, const char* details = ""){
+  printf("%-56s %s%s\n", name, (ok ? "ok" : "FAILED "), (ok ? "" : details));
+  if(!ok)
+    failures++;
+}
+
+/****************************************************************
+ * Stream delivering the bytes of a song up to a limit          *
+ ****************************************************************/
+class starvedStream : public Stream
+{
+  private:
+      const char*     m_data;               //bytes of the song
+      unsigned int    m_size;               //size of the song
+      unsigned int    m_pos;                //amount of bytes read so far
+      unsigned int    m_limit;              //amount of bytes deliverable so far
+
+  public:
+      starvedStream(const char* data, const unsigned int siz)
+      :m_data(data), m_size(siz), m_pos(0), m_limit(siz)
+      {}
+
+      void setLimit(const unsigned int limit){
+        this->m_limit = (limit < this->m_size ? limit : this->m_size);
+      }
+
+      int available(){
+        return this->m_limit - this->m_pos;
+      }
+
+      int read(){
+        return (this->m_pos < this->m_limit ? (unsigned char)this->m_data[this->m_pos++] : -1);
+      }
+
+      size_t write(uint8_t c){
+        (void)c;
+        return 0;
+      }
+};
+
+/****************************************************************
+ * MMLstreamSource shared with MMLstaticTone (which holds its   *
+ *    source by value, where loop() could not refill it)        *
+ ****************************************************************/
+class streamReference
+{
+  private:
+      MMLstreamSource* m_source;            //source refilled by the check
+
+  public:
+      streamReference(MMLstreamSource& source)
+      :m_source(&source)
+      {}
+
+      unsigned int size(){
+        return this->m_source->size();
+      }
+
+      unsigned char fetch(const unsigned int pos, char* buffer, const unsigned char max){
+        return this->m_source->fetch(pos, buffer, max);
+      }
+};
+
+//a stream can only be read forward, its repeated sections are played once
+template<>
+struct MMLsequentialSource<streamReference>{
+  static const bool value = true;
+};
+
+/****************************************************************
+ * Song in memory, counting the tokens fetched from it          *
+ ****************************************************************/
+class countingSource : public MMLsource
+{
+  private:
+      MMLprogmemSource m_source;            //song (PROGMEM is plain memory on the host)
+      unsigned long*  m_fetches;            //amount of tokens fetched so far (shared by the copies)
+
+  public:
+      countingSource(const char* code, const unsigned int siz, unsigned long& fetches)
+      :m_source(code, siz), m_fetches(&fetches)
+      {}
+
+      unsigned int size(){
+        return this->m_source.size();
+      }
+
+      unsigned char fetch(const unsigned int pos, char* buffer, const unsigned char max){
+        (*this->m_fetches)++;
+        return this->m_source.fetch(pos, buffer, max);
+      }
+};
+
+/****************************************************************
+ * I : Melody to play (MMLtone or MMLstaticTone)                *
+ *     Source refilled before each tick (NULL if none)          *
+ *     Stream of the source                                     *
+ *     Bytes delivered by the stream until the tick resume      *
+ *     Tick from which the whole song is delivered              *
+ *     Trace receiving the tone changes                         *
+ * P : Play a melody until it finishes, as loop() and the timer *
+ *     ISR do                                                   *
+ * O : Amount of ticks played                                   *
+ ****************************************************************/
+template<class Melody>
+static unsigned long play(Melody& melody, MMLstreamSource* source, starvedStream* stream,
+                          const unsigned int stall, const unsigned long resume, std::vector<record_t>& out){
+  trace = &out;
+  melody.setup();
+  melody.start();
+  for(tick = 0 ; !melody.finished() && tick < MAXTICKS ; tick++)
+  {
+    if(source)
+    {
+      stream->setLimit(tick < resume ? stall : 0xFFFF);
+      source->refill();
+    }
+    melody.getNextNote();
+    melody.onTick();
+  }
+  melody.stop();
+  trace = 0;
+  return tick;
+}
+
+/****************************************************************
+ * I : Reference trace, and its amount of ticks                 *
+ *     Trace of the starved melody, and its amount of ticks     *
+ *     Tick from which the whole song has been delivered        *
+ *     Buffer receiving the first difference                    *
+ * P : Check that a trace is the reference, the tone changes    *
+ *     from one of them on being delayed by the same amount     *
+ *     of ticks (up to the tick the stream resumed at)          *
+ * O : true if so                                               *
+ ****************************************************************/
+static bool delayed(const std::vector<record_t>& reference, const unsigned long ticks,
+                    const std::vector<record_t>& actual, const unsigned long actualticks,
+                    const unsigned long resume, char* details){
+  unsigned long delay = 0;
+
+  if(actual.size() != reference.size())
+  {
+    sprintf(details, "(%zu tone changes instead of %zu)", actual.size(), reference.size());
+    return false;
+  }
+  for(size_t i = 0 ; i < reference.size() ; i++)
+  {
+    const unsigned long d = actual[i].tick - reference[i].tick;
+    if(actual[i].frequency != reference[i].frequency || actual[i].tick < reference[i].tick
+       || (d != delay && (delay || actual[i].tick > resume)))
+    {
+      sprintf(details, "(change %zu : tick %lu, %u Hz instead of tick %lu, %u Hz)",
+              i + 1, actual[i].tick, actual[i].frequency, reference[i].tick, reference[i].frequency);
+      return false;
+    }
+    delay = d;
+  }
+  if(actualticks < ticks || actualticks - ticks > resume || (delay && actualticks - ticks != delay))
+  {
+    sprintf(details, "(finished after %lu ticks instead of %lu)", actualticks, ticks);
+    return false;
+  }
+  return true;
+}
+
+/****************************************************************
+ * I : MML code                                                 *
+ *     Size of the code (in bytes)                              *
+ *     Buffer receiving the code without its repeats (size + 1) *
+ * P : Remove the [ and ]n tokens, as a stream plays them       *
+ * O : Size of the code left (in bytes)                         *
+ ****************************************************************/
+static unsigned int unrepeated(const char* code, const unsigned int size, char* buffer){
+  unsigned int length = 0;
+  for(unsigned int i = 0 ; i < size && code[i] ; i++)
+  {
+    if(code[i] == '[' || code[i] == ']')
+    {
+      //skip the token and its separator
+      while(i < size && code[i] && code[i] != ' ')
+        i++;
+      continue;
+    }
+    buffer[length++] = code[i];
+  }
+  buffer[length++] = '\0';
+  return length;
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Starve an MMLstreamSource at each byte of the songs      *
+ *     (a stream can not go back, the songs with repeats play   *
+ *     their sections once)                                     *
+ * O : /                                                        *
+ ****************************************************************/
+static void checkStarvedStream(){
+  for(unsigned int s = 0 ; s < NBSONGS ; s++)
+  {
+    //reference : the song without its repeats, read from PROGMEM
+    std::vector<record_t> reference;
+    std::vector<char> code(songs[s].size + 1);
+    MMLprogmemSource progmem(code.data(), unrepeated(songs[s].code, songs[s].size, code.data()));
+    MMLtone original(CHECKPIN, progmem);
+    const unsigned long ticks = play(original, (MMLstreamSource*)0, (starvedStream*)0, 0, 0, reference);
+
+    bool ok = true, fixedok = true;
+    char details[128] = "", fixeddetails[128] = "";
+    for(unsigned int stall = 0 ; stall < songs[s].size && ok && fixedok ; stall++)
+    {
+      //the stream runs dry around the point the song reaches that byte
+      const unsigned long resume = (ticks * stall) / songs[s].size + STALL;
+
+      std::vector<record_t> actual;
+      starvedStream stream(songs[s].code, songs[s].size);
+      MMLstreamSource source(stream, songs[s].size);
+      MMLtone melody(CHECKPIN, source);
+      unsigned long t = play(melody, &source, &stream, stall, resume, actual);
+      ok = delayed(reference, ticks, actual, t, resume + REFILLS, details);
+
+      actual.clear();
+      starvedStream fixedstream(songs[s].code, songs[s].size);
+      MMLstreamSource fixedsource(fixedstream, songs[s].size);
+      MMLstaticTone<CHECKPIN, streamReference> fixed = MMLstaticTone<CHECKPIN, streamReference>(streamReference(fixedsource));
+      t = play(fixed, &fixedsource, &fixedstream, stall, resume, actual);
+      fixedok = delayed(reference, ticks, actual, t, resume + REFILLS, fixeddetails);
+    }
+
+    char name[64];
+    snprintf(name, sizeof(name), "starved stream (%s)", songs[s].name);
+    report(name, ok, details);
+    snprintf(name, sizeof(name), "starved stream (%s, MMLstaticTone)", songs[s].name);
+    report(name, fixedok, fixeddetails);
+  }
+}
+
+/****************************************************************
+ * Timer1 arithmetics at 16 MHz, the ticks being counted by the *
+ *    check instead of the hardware                             *
+ ****************************************************************/
+class periodTimer : public MMLtimer
+{
+  private:
+      MMLtimerPeriod<TIMERCOUNTS> m_period; //timer counts per tick
+      unsigned char   m_scheduled;          //amount of ticks until the next interrupt
+      bool            m_overflow;           //true if a period did not fit in 16 bits
+
+  public:
+      periodTimer()
+      :m_scheduled(1), m_overflow(false)
+      {}
+
+      unsigned char maxTicks(){
+        return this->m_period.maxTicks();
+      }
+
+      void schedule(const unsigned char ticks){
+        if(!ticks || ticks > this->m_period.maxTicks())
+          this->m_overflow = true;
+        this->m_scheduled = ticks;
+        this->m_period.counts(ticks);
+      }
+
+      void setTempo(const unsigned int bpm){
+        this->m_period.setTempo(bpm);
+      }
+
+      unsigned int tempo(){
+        return this->m_period.tempo();
+      }
+
+      unsigned char scheduled(){
+        return this->m_scheduled;
+      }
+
+      bool overflow(){
+        return this->m_overflow;
+      }
+};
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Check the timer1 periods at the lowest tempos, then play *
+ *     a song at T1 in tickless mode                            *
+ * O : /                                                        *
+ ****************************************************************/
+static void checkTimerMinTempo(){
+  const unsigned int minimum = MMLtimerPeriod<TIMERCOUNTS>::minTempo;
+  char details[128] = "";
+  bool ok = (minimum == 4);
+  if(!ok)
+    sprintf(details, "(lowest tempo %u instead of 4)", minimum);
+
+  for(unsigned int bpm = 1 ; bpm <= 2 * minimum && ok ; bpm++)
+  {
+    MMLtimerPeriod<TIMERCOUNTS> period;
+    period.setTempo(bpm);
+    const unsigned int tempo = (bpm < minimum ? minimum : bpm);
+    const unsigned char maximum = period.maxTicks();
+
+    //a whole period fits, and the counts of a minute's ticks add up to the exact amount
+    unsigned long total = 0, ticks = 0;
+    bool fits = (maximum >= 1);
+    while(fits && ticks < (unsigned long)tempo * MMLTICKSPERBEAT)
+    {
+      const unsigned long counts = period.counts(maximum);
+      fits = (counts >= 1 && counts <= 0x10000UL);
+      total += counts;
+      ticks += maximum;
+    }
+    const unsigned long expected = (unsigned long)(((unsigned long long)TIMERCOUNTS * ticks) / ((unsigned long)tempo * MMLTICKSPERBEAT));
+    ok = (period.tempo() == tempo && fits && total == expected);
+    if(!ok)
+      sprintf(details, "(at %u BPM : tempo %u, %u ticks per period, %lu counts instead of %lu)",
+              bpm, period.tempo(), maximum, total, expected);
+  }
+  report("timer1 periods at the lowest tempos", ok, details);
+
+  //the same song, on every tick then in tickless mode
+  static const char song[] = "T1 8C D8 8E F4 8G";
+  std::vector<record_t> reference, actual;
+  MMLtone melody(CHECKPIN, song, sizeof(song));
+  const unsigned long ticks = play(melody, (MMLstreamSource*)0, (starvedStream*)0, 0, 0, reference);
+
+  MMLtone voice(CHECKPIN, song, sizeof(song));
+  MMLsequencer sequencer;
+  periodTimer timer;
+  sequencer.add(voice);
+  sequencer.setup();
+  sequencer.start();
+  trace = &actual;
+  for(tick = 0 ; !sequencer.finished() && tick < MAXTICKS ; tick += timer.scheduled())
+    sequencer.onTimer(timer);
+  sequencer.stop();
+  trace = 0;
+
+  ok = (!timer.overflow() && timer.tempo() == minimum && actual.size() == reference.size());
+  for(size_t i = 0 ; ok && i < reference.size() ; i++)
+    ok = (actual[i].tick == reference[i].tick && actual[i].frequency == reference[i].frequency);
+  snprintf(details, sizeof(details), "(%zu tone changes in %lu ticks instead of %zu in %lu, tempo %u)",
+           actual.size(), tick, reference.size(), ticks, timer.tempo());
+  report("tickless song at T1", ok, details);
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Check that a timer1 period of several ticks lasts the    *
+ *     counts of as many periods of a single tick, at every     *
+ *     tempo                                                    *
+ * O : /                                                        *
+ ****************************************************************/
+static void checkTimerPeriods(){
+  char details[128] = "";
+  bool ok = true;
+
+  for(unsigned int bpm = 1 ; bpm <= MMLMAXTEMPO && ok ; bpm++)
+  {
+    MMLtimerPeriod<TIMERCOUNTS> periods, single;
+    periods.setTempo(bpm);
+    single.setTempo(bpm);
+    const unsigned char maximum = periods.maxTicks();
+
+    //periods of every length, a minute's worth of ticks at least
+    unsigned long total = 0, expected = 0, ticks = 0;
+    for(unsigned int i = 0 ; ok && ticks < 2UL * periods.tempo() * MMLTICKSPERBEAT ; i++)
+    {
+      const unsigned char length = 1 + (i * 7) % maximum;
+      total += periods.counts(length);
+      for(unsigned char t = 0 ; t < length ; t++)
+        expected += single.counts(1);
+      ticks += length;
+      ok = (total == expected);
+    }
+    if(!ok)
+      sprintf(details, "(at %u BPM : %lu counts instead of %lu after %lu ticks)", bpm, total, expected, ticks);
+  }
+  report("timer1 periods of several ticks", ok, details);
+}
+
+static MMLcontrol* volatile isrcontrol = 0;
+
+/****************************************************************
+ * I : Signal number                                            *
+ * P : Timer signal standing in for the timer ISR               *
+ * O : /                                                        *
+ ****************************************************************/
+static void onTimerSignal(int signum){
+  (void)signum;
+  if(isrcontrol)
+    isrcontrol->onTick();
+}
+
+/****************************************************************
+ * I : Melody                                                   *
+ * P : Get the status of a melody, as MMLcontrol publishes it   *
+ * O : Status                                                   *
+ ****************************************************************/
+static MMLstatus statusOf(MMLtone& melody){
+  MMLstatus status;
+  status.flags = (melody.started() ? MMLSTS_STARTED : 0) | (melody.finished() ? MMLSTS_FINISHED : 0)
+               | (melody.last() ? MMLSTS_LAST : 0);
+  status.position = melody.position();
+  return status;
+}
+
+/****************************************************************
+ * I : Melody                                                   *
+ * P : Play a tick as MMLcontrol::onTick() does                 *
+ * O : /                                                        *
+ ****************************************************************/
+static void tickOf(MMLtone& melody){
+  melody.getNextNote();
+  melody.onTick();
+  if(melody.finished() && melody.started())
+    melody.stop();
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Fill the queue of MMLcontrol on each round, and compare  *
+ *     the status published with a melody driven directly,      *
+ *     then read the status while a timer signal ticks          *
+ * O : /                                                        *
+ ****************************************************************/
+static void checkControl(){
+  //beginning of each note of the song
+  std::vector<unsigned int> notes(1, 0);
+  for(unsigned int i = 0 ; i + 1 < songs[0].size ; i++)
+    if(songs[0].code[i] == ' ')
+      notes.push_back(i + 1);
+
+  MMLtone melody(CHECKPIN, songs[0].code, songs[0].size), reference(CHECKPIN, songs[0].code, songs[0].size);
+  MMLcontrol control(melody);
+  melody.setup();
+  reference.setup();
+
+  char details[128] = "";
+  bool ok = true;
+  unsigned long commands = 0;
+  srand(1);
+  for(unsigned int round = 0 ; round < ROUNDS && ok ; round++)
+  {
+    //fill the queue, the same commands being applied to the reference
+    unsigned int posted = 0;
+    for(bool accepted = true ; accepted ; )
+    {
+      const unsigned int pos = notes[rand() % notes.size()];
+      switch(reference.finished() && !posted ? 0 : rand() % 4){
+        case 0:
+            accepted = control.play();
+            if(accepted){ reference.reset(); reference.start(); }
+            break;
+
+        case 1:
+            accepted = control.pause();
+            if(accepted) reference.stop();
+            break;
+
+        case 2:
+            accepted = control.resume();
+            if(accepted) reference.start();
+            break;
+
+        default:
+            accepted = control.seek(pos);
+            if(accepted) reference.seek(pos);
+            break;
+      }
+      posted += accepted;
+    }
+    commands += posted;
+
+    //executed in order on the next tick, then the queue is free again
+    control.onTick();
+    tickOf(reference);
+    const MMLstatus actual = control.status(), expected = statusOf(reference);
+    ok = (posted == MMLQUEUESZ && actual.flags == expected.flags && actual.position == expected.position);
+    if(!ok)
+      sprintf(details, "(round %u : %u commands posted, flags %02X position %u instead of %02X %u)",
+              round, posted, actual.flags, actual.position, expected.flags, expected.position);
+
+    //a few ticks without any command
+    for(int t = rand() % 8 ; t > 0 && ok ; t--)
+    {
+      control.onTick();
+      tickOf(reference);
+      ok = (control.status().flags == statusOf(reference).flags && control.status().position == reference.position());
+      if(!ok)
+        sprintf(details, "(round %u : status differs after the commands)", round);
+    }
+  }
+  char name[64];
+  snprintf(name, sizeof(name), "control queue (%lu commands)", commands);
+  report(name, ok, details);
+
+  //every status the ISR may publish : a short song (its status changing every few ticks)
+  //  played a few times in a row
+  static const char shortsong[] = "4C32 D32 E32";
+  std::set<unsigned long> published;
+  MMLtone single(CHECKPIN, shortsong, sizeof(shortsong));
+  single.setup();
+  single.start();
+  for(unsigned int p = 0 ; p < 3 ; )
+  {
+    tickOf(single);
+    const MMLstatus status = statusOf(single);
+    published.insert(((unsigned long)status.flags << 16) | status.position);
+    if(single.finished())
+    {
+      single.reset();
+      single.start();
+      p++;
+    }
+  }
+
+  //loop() plays the song again once finished, while the ISR ticks
+  MMLtone interrupted(CHECKPIN, shortsong, sizeof(shortsong));
+  MMLcontrol interruptedcontrol(interrupted);
+  interrupted.setup();
+  interruptedcontrol.play();
+  isrcontrol = &interruptedcontrol;
+  signal(SIGALRM, onTimerSignal);
+  struct itimerval period = {{0, PERIOD}, {0, PERIOD}};
+  setitimer(ITIMER_REAL, &period, NULL);
+
+  unsigned long reads = 0, torn = 0, plays = 0;
+  MMLstatus wrong = {0, 0};
+  while(plays < PLAYS)
+  {
+    const MMLstatus status = interruptedcontrol.status();
+    reads++;
+    if(status.flags && !published.count(((unsigned long)status.flags << 16) | status.position))
+    {
+      torn++;
+      wrong = status;
+    }
+    if(status.flags & MMLSTS_FINISHED)
+      plays += interruptedcontrol.play();
+  }
+  period = {{0, 0}, {0, 0}};
+  setitimer(ITIMER_REAL, &period, NULL);
+  signal(SIGALRM, SIG_DFL);
+  isrcontrol = 0;
+
+  sprintf(details, "(%lu of %lu reads never published, e.g. flags %02X position %u)", torn, reads, wrong.flags, wrong.position);
+  report("control status read while the timer ticks", !torn && reads, details);
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Seek before and after the tempo change of a song, once   *
+ *     it has been played and its tempo set by hand, and check  *
+ *     the tempo restored, the same as when it is rewound       *
+ * O : /                                                        *
+ ****************************************************************/
+static void checkSeekTempo(){
+  static const char song[] = "4C8 D8 T200 E8 F8";
+  MMLcheckpoint checkpoints[4];
+  MMLtone melody(CHECKPIN, song, sizeof(song));
+  const MMLindex index(checkpoints, melody.index(checkpoints, 4, 8));
+  const unsigned long ticks[] = {0, 8, 16, 24};
+  const unsigned int expected[] = {MMLDEFTEMPO, MMLDEFTEMPO, 200, 200};
+  char details[128] = "";
+  bool ok = true;
+
+  for(unsigned int i = 0 ; i < sizeof(ticks) / sizeof(ticks[0]) && ok ; i++)
+  {
+    for(unsigned char indexed = 0 ; indexed < 2 && ok ; indexed++)
+    {
+      std::vector<record_t> out;
+      play(melody, (MMLstreamSource*)0, (starvedStream*)0, 0, 0, out);
+      melody.setTempo(90);
+      if(indexed)
+        melody.seekToTick(ticks[i], index);
+      else
+        melody.seekToTick(ticks[i]);
+
+      ok = (melody.tempo() == expected[i]);
+      if(!ok)
+        sprintf(details, "(tick %lu%s : %u BPM instead of %u)", ticks[i], (indexed ? " with an index" : ""),
+                melody.tempo(), expected[i]);
+    }
+  }
+
+  //rewinding starts the song at the same tempo as seeking to its beginning
+  if(ok)
+  {
+    std::vector<record_t> out;
+    play(melody, (MMLstreamSource*)0, (starvedStream*)0, 0, 0, out);
+    melody.setTempo(90);
+    melody.reset();
+    ok = (melody.tempo() == expected[0]);
+    if(!ok)
+      sprintf(details, "(rewound at %u BPM instead of %u)", melody.tempo(), expected[0]);
+  }
+  report("seek and rewind restore the tempo of the song", ok, details);
+}
+
+/****************************************************************
+ * I : Melody to play (MMLtone or MMLstaticTone)                *
+ *     Amount of tokens fetched from its source so far          *
+ *     Trace receiving the tone changes                         *
+ * P : Play a melody until it finishes, as loop() and the timer *
+ *     ISR do, keeping track of the busiest tick                *
+ * O : Largest amount of tokens fetched during a single tick    *
+ ****************************************************************/
+template<class Melody>
+static unsigned long busiest(Melody& melody, const unsigned long& fetches, std::vector<record_t>& out){
+  unsigned long most = 0;
+
+  trace = &out;
+  melody.setup();
+  melody.start();
+  for(tick = 0 ; !melody.finished() && tick < MAXTICKS ; tick++)
+  {
+    const unsigned long before = fetches;
+    melody.getNextNote();
+    melody.onTick();
+    if(fetches - before > most)
+      most = fetches - before;
+  }
+  melody.stop();
+  trace = 0;
+  return most;
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Play songs running many commands between two notes, and  *
+ *     check that no tick runs more than MMLMAXCOMMANDS of them *
+ * O : /                                                        *
+ ****************************************************************/
+static void checkCommandBound(){
+  static const char empty[] = "4C4 [ [ [ ]255 ]255 ]255 D4";
+  static const char plain[] = "4C4 D4";
+  static const char reference[] = "4C4 T0 D4";
+  char tempos[256] = "4C4";
+  char details[128] = "";
+  unsigned long fetches = 0;
+
+  //sections without any note are played once, taking no time
+  {
+    std::vector<record_t> expected, out, staticout;
+    countingSource plainsource(plain, sizeof(plain), fetches);
+    MMLtone plainmelody(CHECKPIN, plainsource);
+    busiest(plainmelody, fetches, expected);
+
+    countingSource source(empty, sizeof(empty), fetches);
+    MMLtone melody(CHECKPIN, source);
+    fetches = 0;
+    const unsigned long most = busiest(melody, fetches, out);
+    const unsigned long total = fetches;
+    MMLstaticTone<CHECKPIN, countingSource> staticmelody = MMLstaticTone<CHECKPIN, countingSource>(countingSource(empty, sizeof(empty), fetches));
+    fetches = 0;
+    const unsigned long staticmost = busiest(staticmelody, fetches, staticout);
+
+    const bool ok = (out.size() == expected.size() && staticout.size() == expected.size() && most <= MMLMAXCOMMANDS + 1
+                  && staticmost <= MMLMAXCOMMANDS + 1 && total < 2 * sizeof(empty));
+    for(unsigned int i = 0 ; ok && i < expected.size() ; i++)
+      if(out[i].tick != expected[i].tick || out[i].frequency != expected[i].frequency
+      || staticout[i].tick != expected[i].tick || staticout[i].frequency != expected[i].frequency)
+      {
+        sprintf(details, "(tone change %u differs from \"%s\")", i, plain);
+        report("empty repeated sections played once", false, details);
+        return;
+      }
+    sprintf(details, "(%lu tokens fetched, %lu and %lu in a single tick)", total, most, staticmost);
+    report("empty repeated sections played once", ok, details);
+  }
+
+  //commands beyond MMLMAXCOMMANDS wait for the next tick, the note being held
+  {
+    unsigned int n = 0;
+    for( ; n < 2 * MMLMAXCOMMANDS + 4 ; n++)
+      strcat(tempos, " T0");
+    strcat(tempos, " D4");
+
+    std::vector<record_t> expected, out, staticout;
+    countingSource referencesource(reference, sizeof(reference), fetches);
+    MMLtone referencemelody(CHECKPIN, referencesource);
+    busiest(referencemelody, fetches, expected);
+
+    countingSource source(tempos, strlen(tempos) + 1, fetches);
+    MMLtone melody(CHECKPIN, source);
+    fetches = 0;
+    const unsigned long most = busiest(melody, fetches, out);
+    MMLstaticTone<CHECKPIN, countingSource> staticmelody = MMLstaticTone<CHECKPIN, countingSource>(countingSource(tempos, strlen(tempos) + 1, fetches));
+    fetches = 0;
+    const unsigned long staticmost = busiest(staticmelody, fetches, staticout);
+
+    //the second note is delayed by a tick for each MMLMAXCOMMANDS commands beyond the first ones
+    const unsigned long delay = n / MMLMAXCOMMANDS;
+    bool ok = (out.size() == expected.size() && staticout.size() == expected.size() && expected.size() >= 2
+            && most <= MMLMAXCOMMANDS + 1 && staticmost <= MMLMAXCOMMANDS + 1);
+    for(unsigned int i = 0 ; ok && i < expected.size() ; i++)
+    {
+      const unsigned long t = expected[i].tick + (i ? delay : 0);
+      ok = (out[i].tick == t && out[i].frequency == expected[i].frequency
+         && staticout[i].tick == t && staticout[i].frequency == expected[i].frequency);
+    }
+    sprintf(details, "(%lu and %lu tokens fetched in a single tick)", most, staticmost);
+    report("commands per tick bounded by MMLMAXCOMMANDS", ok, details);
+  }
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Play two voices sharing the default output, one of them  *
+ *     detuned, and check that the other one stays in tune      *
+ * O : /                                                        *
+ ****************************************************************/
+static void checkSharedDetune(){
+  static const char song[] = "4C8 D8";
+  const uint16_t ratio = MMLpitch::ratio(50);
+  MMLtone tuned(CHECKPIN, song, sizeof(song));
+  MMLtone detuned(CHECKPIN, song, sizeof(song));
+  std::vector<record_t> reference, out;
+  char details[128] = "";
+
+  detuned.setDetune(50);
+  play(tuned, (MMLstreamSource*)0, (starvedStream*)0, 0, 0, reference);
+  play(detuned, (MMLstreamSource*)0, (starvedStream*)0, 0, 0, out);
+
+  bool ok = (!reference.empty() && reference[0].frequency == MMLpitchTable<>::frequencies[NOTE_C4] && out.size() == reference.size());
+  if(!ok)
+    sprintf(details, "(first tone %u Hz instead of %u)", (reference.empty() ? 0 : reference[0].frequency), MMLpitchTable<>::frequencies[NOTE_C4]);
+
+  for(unsigned int i = 0 ; i < reference.size() && ok ; i++)
+  {
+    const unsigned int expected = ((uint32_t)reference[i].frequency * ratio + (MMLUNITY >> 1)) >> 15;
+    ok = (out[i].tick == reference[i].tick && out[i].frequency == expected);
+    if(!ok)
+      sprintf(details, "(tick %lu : %u Hz instead of %u)", out[i].tick, out[i].frequency, expected);
+  }
+  report("detune kept by each voice sharing an output", ok, details);
+}
+
+int main(){
+  hostToneHook = record;
+
+  checkStarvedStream();
+  checkTimerMinTempo();
+  checkTimerPeriods();
+  checkSeekTempo();
+  checkSharedDetune();
+  checkCommandBound();
+  checkControl();
+
+  if(failures)
+    printf("\n%u check(s) failed\n", failures);
+  else
+    printf("\nall checks passed\n");
+  return (failures ? 1 : 0);
+}
@@ -0,0 +1,564 @@
+/*
+ * fuzz.cpp
+ * -----------------------------------------------
+ * Fuzzing and differential testing harness of the MML decoder.
+ *
+ * Each input is played as MML code by every decoding path, exactly as the timer
+ *    ISR would (getNextNote() then onTick() on each tick), and the tone()/noTone()
+ *    calls of each path are recorded with their tick, along with the envelope parameters set :
+ * - MMLtone reading the code as PROGMEM (reference)
+ * - MMLtone reading the code from an MMLprogmemSource
+ * - MMLtone playing the events pre-decoded by MMLcompiler.h (compiled at run time)
+ * - MMLsequencer playing the reference as its only voice
+ * - MMLtone playing the reference through a recording output (see MMLrecordOutput.h),
+ *   then transposed, its notes being compared with the ones recorded, moved by hand
+ * - MMLstaticTone playing the code from an MMLprogmemSource, then the pre-decoded events
+ * - MMLtone and MMLstaticTone playing the events packed by MMLpacker.h
+ * - MMLtone resuming from a tick (seekToTick()), without then with an index : its trace must
+ *   be the end of the reference, from the tick at which the note played then starts
+ *   (the packed song as well, with an index)
+ * Songs whose repeated sections hold no note are rejected by the validator (static_assert),
+ *    and played through every path before the random inputs.
+ * A song of more tokens than the default -fconstexpr-depth (512) is validated and compiled
+ *    at compile time (static_assert), as MML_COMPILE does.
+ * Any difference between the paths, along with the faults caught by the sanitizers
+ *    (buffer overflows, divisions by zero...), aborts with the offending input.
+ *
+ * Build with libFuzzer (from the repository root) :
+ *    clang++ -g -O1 -std=gnu++11 -fsanitize=fuzzer,address,undefined -DMMLLIBFUZZER -I. -Iextras/host *.cpp extras/host/Arduino.cpp extras/host/fuzz.cpp -o mmlfuzz
+ *
+ * Build standalone (random inputs, or files given by AFL or a corpus) :
+ *    g++ -g -O1 -std=gnu++11 -fsanitize=address,undefined -I. -Iextras/host *.cpp extras/host/Arduino.cpp extras/host/fuzz.cpp -o mmlfuzz
+ *
+ * Usage (standalone) :
+ *    ./mmlfuzz [-n iterations] [-s seed] [input ...]
+ *      -n : amount of random inputs (default 100000), derived from the songs of songs.h
+ *      -s : seed of the random generator (default 1)
+ *      Input files are replayed instead of random inputs (AFL : ./mmlfuzz @@).
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#include "MMLtone.h"
+#include "MMLsequencer.h"
+#include "MMLcompiler.h"
+#include "MMLrecordOutput.h"
+#include "MMLstaticTone.h"
+#include "MMLpacker.h"
+#include "songs.h"
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
+#define MAXINPUT  512       //longest input (compiling the events walks the code once per event)
+#define MAXTICKS  100000    //ticks after which a song is considered endless
+#define FUZZPIN   12
+#define ENVMARK   0x10000   //envelope parameter set (instead of a frequency : ENVMARK | parameter << 8 | value)
+
+//songs running only commands in repeated sections : rejected by the validator (checked at compile time),
+//  and played through every path before the random inputs, as they could keep a single tick busy for long
+#define EMPTYNESTED   "4C4 [ [ [ ]255 ]255 ]255 D4"
+#define EMPTYCOMMANDS "4C4 [ T100 @A20 ]255 D4"
+static_assert(MMLvalidator::validate(EMPTYNESTED, sizeof(EMPTYNESTED)).reason == MMLERR_REPEAT
+           && MMLvalidator::validate(EMPTYNESTED, sizeof(EMPTYNESTED)).offset == 10, "a section without any note must be rejected");
+static_assert(MMLvalidator::validate(EMPTYCOMMANDS, sizeof(EMPTYCOMMANDS)).reason == MMLERR_REPEAT
+           && MMLvalidator::validate(EMPTYCOMMANDS, sizeof(EMPTYCOMMANDS)).offset == 16, "a section of commands only must be rejected");
+static_assert(MMLvalidator::validate("4C4 [ [ D4 ]3 ]2 E4", sizeof("4C4 [ [ D4 ]3 ]2 E4")).reason == MMLERR_NONE,
+              "a section holding a note through a nested one must be accepted");
+static_assert(MMLvalidator::validate("4C4 [ D4 [ ]2 ]2", sizeof("4C4 [ D4 [ ]2 ]2")).reason == MMLERR_REPEAT,
+              "an empty section nested in another one must be rejected");
+
+//song of 514 tokens, deeper than the default -fconstexpr-depth if it was walked token by token
+#define LONGX4(s)     s s s s
+#define LONGSONG      "4C8 " LONGX4(LONGX4(LONGX4(LONGX4("D8 E8 ")))) "C8"
+static_assert(MMLvalidator::validate(LONGSONG, sizeof(LONGSONG)).reason == MMLERR_NONE, "a long song must be validated in full");
+static_assert(MMLvalidator::validate(LONGSONG " X8", sizeof(LONGSONG " X8")).reason == MMLERR_LETTER
+           && MMLvalidator::validate(LONGSONG " X8", sizeof(LONGSONG " X8")).offset == sizeof(LONGSONG),
+              "the last token of a long song must be checked");
+static_assert(MMLcompiler::count(LONGSONG, sizeof(LONGSONG)) == 514, "a long song must be compiled in full");
+static_assert(MMLcompiler::compile(LONGSONG, sizeof(LONGSONG), 513) == MMLcompiler::compile("4C8", sizeof("4C8"), 0),
+              "the last note of a long song must keep the octave set by the first one");
+
+typedef struct{
+  unsigned long   tick;     //tick at which the tone changed
+  unsigned int    frequency;//frequency played (0 for noTone()), or envelope parameter set (see ENVMARK)
+}record_t;
+
+static std::vector<record_t>* trace = 0;
+static unsigned long tick = 0;
+
+/****************************************************************
+ * tone() output, recording the envelope parameters set as well *
+ ****************************************************************/
+class traceOutput : public MMLtoneOutput
+{
+  public:
+      void envelope(const unsigned char pin, const unsigned char param, const unsigned char value){
+        (void)pin;
+        if(trace)
+          trace->push_back({tick, ENVMARK | ((unsigned int)param << 8) | value});
+      }
+};
+
+static traceOutput output;
+
+/****************************************************************
+ * I : Pin of the tone                                          *
+ *     Frequency played (0 for noTone())                        *
+ * P : Record a tone change in the current trace                *
+ * O : /                                                        *
+ ****************************************************************/
+static void record(uint8_t pin, unsigned int frequency){
+  (void)pin;
+  if(trace)
+    trace->push_back({tick, frequency});
+}
+
+/****************************************************************
+ * I : Melody to play                                           *
+ *     Trace receiving the tone changes                         *
+ * P : Play a melody until it finishes, as the timer ISR does   *
+ * O : Amount of ticks played                                   *
+ ****************************************************************/
+static unsigned long play(MMLtone& melody, std::vector<record_t>& out){
+  trace = &out;
+  melody.setOutput(output);
+  melody.setup();
+  melody.start();
+  for(tick = 0 ; !melody.finished() && tick < MAXTICKS ; tick++)
+  {
+    melody.getNextNote();
+    melody.onTick();
+  }
+  melody.stop();
+  trace = 0;
+  return tick;
+}
+
+/****************************************************************
+ * I : Melody fixed at compile time                             *
+ *     Trace receiving the tone changes                         *
+ * P : Play a melody until it finishes, as the timer ISR does   *
+ * O : Amount of ticks played                                   *
+ ****************************************************************/
+template<class Melody>
+static unsigned long playStatic(Melody& melody, std::vector<record_t>& out){
+  trace = &out;
+  melody.setup();
+  melody.start();
+  for(tick = 0 ; !melody.finished() && tick < MAXTICKS ; tick++)
+  {
+    melody.getNextNote();
+    melody.onTick();
+  }
+  melody.stop();
+  trace = 0;
+  return tick;
+}
+
+/****************************************************************
+ * I : Melody to play as the only voice of a sequencer          *
+ *     Trace receiving the tone changes                         *
+ * P : Play a melody through a sequencer until it finishes      *
+ * O : Amount of ticks played                                   *
+ ****************************************************************/
+static unsigned long sequence(MMLtone& melody, std::vector<record_t>& out){
+  MMLsequencer sequencer;
+  melody.setOutput(output);
+  sequencer.add(melody);
+
+  trace = &out;
+  sequencer.setup();
+  sequencer.start();
+  for(tick = 0 ; !sequencer.finished() && tick < MAXTICKS ; tick++)
+    sequencer.onTick();
+  sequencer.stop();
+  trace = 0;
+  return tick;
+}
+
+/****************************************************************
+ * I : Melody to play through a recording output                *
+ *     Trace receiving the tone changes                         *
+ *     Semitones added to the valid notes recorded (clamped)    *
+ * P : Play a melody until it finishes, then turn the calls     *
+ *     made to the output into tone changes                     *
+ * O : Amount of ticks played                                   *
+ ****************************************************************/
+static unsigned long record(MMLtone& melody, std::vector<record_t>& out, const int semitones = 0){
+  MMLrecordOutput output;
+  melody.setOutput(output);
+
+  melody.setup();
+  melody.start();
+  for(tick = 0 ; !melody.finished() && tick < MAXTICKS ; tick++)
+  {
+    output.setTick(tick);
+    melody.getNextNote();
+    melody.onTick();
+  }
+  output.setTick(tick);
+  melody.stop();
+  melody.setOutput(MMLdefaultOutput);
+
+  //the default output plays invalid notes at 0 Hz
+  const std::vector<MMLrecord>& calls = output.records();
+  for(size_t i = 0 ; i < calls.size() ; i++)
+  {
+    if(calls[i].type == MMLREC_PLAY)
+    {
+      int note = calls[i].note;
+      if(note <= NOTE_B8)
+        note = std::min(std::max(note + semitones, (int)NOTE_A0), (int)NOTE_B8);
+      out.push_back({calls[i].tick, (note < NBNOTES ? (unsigned int)pgm_read_word_near(MMLpitchTable<>::frequencies + note) : 0u)});
+    }
+    else if(calls[i].type == MMLREC_MUTE)
+      out.push_back({calls[i].tick, 0});
+    else if(calls[i].type == MMLREC_ENVELOPE)
+      out.push_back({calls[i].tick, ENVMARK | ((unsigned int)calls[i].note << 8) | calls[i].value});
+  }
+  return tick;
+}
+
+/****************************************************************
+ * I : Reference trace                                          *
+ *     Tick from which the trace is kept                        *
+ *     Trace receiving the end of the reference                 *
+ * P : Keep the tone changes from a tick on, as if the song     *
+ *     started there (the envelope parameters set on that very  *
+ *     tick are set while seeking, before the trace starts)     *
+ * O : /                                                        *
+ ****************************************************************/
+static void suffix(const std::vector<record_t>& reference, const unsigned long from, std::vector<record_t>& out){
+  for(size_t i = 0 ; i < reference.size() ; i++)
+  {
+    if(reference[i].tick > from || (reference[i].tick == from && !(reference[i].frequency & ENVMARK)))
+      out.push_back({reference[i].tick - from, reference[i].frequency});
+  }
+}
+
+/****************************************************************
+ * I : Input                                                    *
+ *     Size of the input                                        *
+ *     Name of the path which differs                           *
+ *     Reference trace, trace of the path                       *
+ * P : Print the input and the first difference, then abort     *
+ * O : /                                                        *
+ ****************************************************************/
+static void fail(const uint8_t* data, const size_t size, const char* path,
+                 const std::vector<record_t>& expected, const std::vector<record_t>& actual){
+  fprintf(stderr, "difference in %s on input \"", path);
+  for(size_t i = 0 ; i < size ; i++)
+    fprintf(stderr, (data[i] >= ' ' && data[i] < 0x7F && data[i] != '"' ? "%c" : "\\x%02X"), data[i]);
+  fprintf(stderr, "\" (%zu bytes)\n", size);
+
+  size_t i = 0;
+  while(i < expected.size() && i < actual.size()
+        && expected[i].tick == actual[i].tick && expected[i].frequency == actual[i].frequency)
+    i++;
+
+  if(i < expected.size())
+    fprintf(stderr, "  expected : tick %lu, %u Hz\n", expected[i].tick, expected[i].frequency);
+  else
+    fprintf(stderr, "  expected : end of the song\n");
+  if(i < actual.size())
+    fprintf(stderr, "  actual   : tick %lu, %u Hz\n", actual[i].tick, actual[i].frequency);
+  else
+    fprintf(stderr, "  actual   : end of the song\n");
+  abort();
+}
+
+/****************************************************************
+ * I : Reference and path traces, with their amount of ticks    *
+ * P : Compare two traces                                       *
+ * O : true if identical                                        *
+ ****************************************************************/
+static bool same(const std::vector<record_t>& a, const unsigned long ticksa,
+                 const std::vector<record_t>& b, const unsigned long ticksb){
+  if(ticksa != ticksb || a.size() != b.size())
+    return false;
+
+  for(size_t i = 0 ; i < a.size() ; i++)
+  {
+    if(a[i].tick != b[i].tick || a[i].frequency != b[i].frequency)
+      return false;
+  }
+  return true;
+}
+
+/****************************************************************
+ * I : Input (MML code)                                         *
+ *     Size of the input                                        *
+ * P : Play an input through every path and compare the traces  *
+ * O : 0                                                        *
+ ****************************************************************/
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size){
+  if(!size || size > MAXINPUT)
+    return 0;
+
+  //exact-size copy, so that the sanitizers catch any read past the end
+  std::vector<char> code(data, data + size);
+  const char* text = code.data();
+  const unsigned int siz = (unsigned int)size;
+
+  //reference : MML code as PROGMEM
+  std::vector<record_t> reference, other;
+  MMLtone melody(FUZZPIN, text, siz);
+  const unsigned long ticks = play(melody, reference);
+
+  //note by note from a source
+  MMLprogmemSource source(text, siz);
+  MMLtone sourced(FUZZPIN, source);
+  unsigned long t = play(sourced, other);
+  if(!same(reference, ticks, other, t) || sourced.last() != melody.last())
+    fail(data, size, "MMLprogmemSource", reference, other);
+
+  //pre-decoded events
+  std::vector<uint16_t> events(MMLcompiler::count(text, siz));
+  for(unsigned int i = 0 ; i < events.size() ; i++)
+    events[i] = MMLcompiler::compile(text, siz, i);
+  MMLtone compiled(FUZZPIN, events.data(), events.size());
+  other.clear();
+  t = play(compiled, other);
+  if(!same(reference, ticks, other, t) || compiled.last() != melody.last())
+    fail(data, size, "pre-decoded events", reference, other);
+
+  //sequencer
+  MMLtone voice(FUZZPIN, text, siz);
+  other.clear();
+  t = sequence(voice, other);
+  if(!same(reference, ticks, other, t))
+    fail(data, size, "MMLsequencer", reference, other);
+
+  //recording output
+  MMLtone recorded(FUZZPIN, text, siz);
+  other.clear();
+  t = record(recorded, other);
+  if(!same(reference, ticks, other, t))
+    fail(data, size, "MMLrecordOutput", reference, other);
+
+  //transposed : the notes recorded without transposition, moved by hand
+  const int semitones = (int)(size % 49) - 24;
+  std::vector<record_t> moved;
+  MMLtone original(FUZZPIN, text, siz), transposed(FUZZPIN, text, siz);
+  record(original, moved, semitones);
+  transposed.setTranspose(semitones);
+  other.clear();
+  t = record(transposed, other);
+  if(!same(moved, t, other, t) || t != ticks)
+    fail(data, size, "setTranspose()", moved, other);
+
+  //melodies fixed at compile time
+  MMLstaticTone<FUZZPIN, MMLprogmemSource, traceOutput> fixed = MMLstaticTone<FUZZPIN, MMLprogmemSource, traceOutput>(MMLprogmemSource(text, siz));
+  other.clear();
+  t = playStatic(fixed, other);
+  if(!same(reference, ticks, other, t) || fixed.last() != melody.last())
+    fail(data, size, "MMLstaticTone", reference, other);
+
+  MMLstaticTone<FUZZPIN, MMLeventSource, traceOutput> fixedEvents = MMLstaticTone<FUZZPIN, MMLeventSource, traceOutput>(MMLeventSource(events.data(), events.size()));
+  other.clear();
+  t = playStatic(fixedEvents, other);
+  if(!same(reference, ticks, other, t) || fixedEvents.last() != melody.last())
+    fail(data, size, "MMLstaticTone (pre-decoded events)", reference, other);
+
+  //packed song (exact-size copy, as the events)
+  const std::vector<uint8_t> built = MMLpack(events.data(), events.size());
+  const std::vector<uint8_t> packed(built.begin(), built.end());
+  MMLtone unpacked(FUZZPIN, packed.data(), packed.size());
+  other.clear();
+  t = play(unpacked, other);
+  if(!same(reference, ticks, other, t) || unpacked.last() != melody.last())
+    fail(data, size, "packed song", reference, other);
+
+  MMLstaticTone<FUZZPIN, MMLpackedSource, traceOutput> fixedPacked = MMLstaticTone<FUZZPIN, MMLpackedSource, traceOutput>(MMLpackedSource(packed.data(), packed.size()));
+  other.clear();
+  t = playStatic(fixedPacked, other);
+  if(!same(reference, ticks, other, t) || fixedPacked.last() != melody.last())
+    fail(data, size, "MMLstaticTone (packed song)", reference, other);
+
+  //resuming from a tick (songs stopped at MAXTICKS are left out)
+  if(ticks < MAXTICKS)
+  {
+    const unsigned long target = (ticks * (size % 5)) / 4;
+    std::vector<record_t> expected;
+    MMLtone seeked(FUZZPIN, text, siz);
+    const unsigned long from = seeked.seekToTick(target);
+    suffix(reference, from, expected);
+    other.clear();
+    t = play(seeked, other);
+    if(from > target || !same(expected, ticks - from, other, t))
+      fail(data, size, "seekToTick()", expected, other);
+
+    //same, from the last checkpoint before the tick
+    std::vector<MMLcheckpoint> checkpoints(64);
+    MMLtone indexed(FUZZPIN, text, siz);
+    checkpoints.resize(indexed.index(checkpoints.data(), checkpoints.size(), 1 + size % 32));
+    MMLindex index(checkpoints.data(), checkpoints.size());
+    other.clear();
+    if(indexed.seekToTick(target, index) != from)
+      fail(data, size, "seekToTick() with an index", expected, other);
+    t = play(indexed, other);
+    if(!same(expected, ticks - from, other, t))
+      fail(data, size, "seekToTick() with an index", expected, other);
+
+    //same, in the packed song
+    MMLtone packedIndexed(FUZZPIN, packed.data(), packed.size());
+    checkpoints.resize(64);
+    checkpoints.resize(packedIndexed.index(checkpoints.data(), checkpoints.size(), 1 + size % 32));
+    MMLindex packedIndex(checkpoints.data(), checkpoints.size());
+    other.clear();
+    if(packedIndexed.seekToTick(target, packedIndex) != from)
+      fail(data, size, "seekToTick() in the packed song", expected, other);
+    t = play(packedIndexed, other);
+    if(!same(expected, ticks - from, other, t))
+      fail(data, size, "seekToTick() in the packed song", expected, other);
+  }
+
+  return 0;
+}
+
+#ifndef MMLLIBFUZZER
+static uint32_t state = 1;
+
+/****************************************************************
+ * I : /                                                        *
+ * P : Draw a pseudo-random number (xorshift)                   *
+ * O : Random number                                            *
+ ****************************************************************/
+static uint32_t randomNumber(){
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+/****************************************************************
+ * I : Buffer receiving the input                               *
+ * P : Build a random input : a song of songs.h mutated, or     *
+ *     tokens made of MML characters                            *
+ * O : /                                                        *
+ ****************************************************************/
+static void generate(std::vector<uint8_t>& input){
+  static const char alphabet[] = "0123456789AaBbCcDdEeFfGgHh#+-./ T[]@SsRr ";
+  input.clear();
+
+  //random tokens
+  if(randomNumber() & 1)
+  {
+    const unsigned int len = 1 + randomNumber() % 64;
+    for(unsigned int i = 0 ; i < len ; i++)
+      input.push_back((randomNumber() % 32) ? alphabet[randomNumber() % (sizeof(alphabet) - 1)] : randomNumber() & 0xFF);
+    return;
+  }
+
+  //mutated song (characters replaced, inserted, removed)
+  const song_t& song = songs[randomNumber() % NBSONGS];
+  input.assign(song.code, song.code + song.size);
+  const unsigned int mutations = 1 + randomNumber() % 8;
+  for(unsigned int m = 0 ; m < mutations && !input.empty() ; m++)
+  {
+    const size_t pos = randomNumber() % input.size();
+    const uint8_t c = alphabet[randomNumber() % (sizeof(alphabet) - 1)];
+    switch(randomNumber() % 3){
+      case 0:
+          input[pos] = c;
+          break;
+
+      case 1:
+          input.insert(input.begin() + pos, c);
+          break;
+
+      default:
+          input.erase(input.begin() + pos);
+          break;
+    }
+  }
+}
+
+/****************************************************************
+ * I : Path of the input file                                   *
+ *     Buffer receiving the input                               *
+ * P : Read an input file                                       *
+ * O : true if read, false otherwise                            *
+ ****************************************************************/
+static bool readInput(const char* path, std::vector<uint8_t>& input){
+  FILE* f = fopen(path, "rb");
+  if(!f)
+    return false;
+
+  int c;
+  input.clear();
+  while((c = fgetc(f)) != EOF)
+    input.push_back((uint8_t)c);
+  fclose(f);
+  return true;
+}
+
+int main(int argc, char* argv[]){
+  unsigned long iterations = 100000;
+  std::vector<uint8_t> input;
+  int a = 1;
+
+  hostToneHook = record;
+
+  //parse the options
+  for( ; a < argc && argv[a][0] == '-' ; a++)
+  {
+    if(a + 1 >= argc)
+    {
+      fprintf(stderr, "usage : %s [-n iterations] [-s seed] [input ...]\n", argv[0]);
+      return 2;
+    }
+    if(!strcmp(argv[a], "-n"))
+      iterations = strtoul(argv[++a], NULL, 10);
+    else if(!strcmp(argv[a], "-s"))
+      state = (uint32_t)strtoul(argv[++a], NULL, 10) | 1;
+    else
+    {
+      fprintf(stderr, "usage : %s [-n iterations] [-s seed] [input ...]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  //replay the input files
+  if(a < argc)
+  {
+    for( ; a < argc ; a++)
+    {
+      if(!readInput(argv[a], input))
+      {
+        fprintf(stderr, "%s : cannot read the input\n", argv[a]);
+        return 2;
+      }
+      LLVMFuzzerTestOneInput(input.data(), input.size());
+    }
+    return 0;
+  }
+
+  //known inputs
+  static const char* const known[] = {EMPTYNESTED, EMPTYCOMMANDS};
+  for(unsigned int k = 0 ; k < sizeof(known) / sizeof(known[0]) ; k++)
+    LLVMFuzzerTestOneInput((const uint8_t*)known[k], strlen(known[k]));
+
+  //random inputs
+  for(unsigned long i = 0 ; i < iterations ; i++)
+  {
+    generate(input);
+    LLVMFuzzerTestOneInput(input.data(), input.size());
+  }
+  printf("%lu inputs, no difference\n", iterations);
+  return 0;
+}
+#else
+//libFuzzer calls the hook set up before the first input
+extern "C" int LLVMFuzzerInitialize(int* argc, char*** argv){
+  (void)argc;
+  (void)argv;
+  hostToneHook = record;
+  return 0;
+}
+#endif
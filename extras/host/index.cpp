@@ -0,0 +1,104 @@
+/*
+ * index.cpp
+ * -----------------------------------------------
+ * Offline generator of the seek index of an MML song (see MMLindex.h).
+ *
+ * The song is walked once by an MMLtone (see MMLtone::index()), and its checkpoints
+ *    are printed as a PROGMEM array, to be pasted next to the song in the sketch :
+ *      const MMLcheckpoint melodyindex[] PROGMEM = { ... };
+ *      MMLindex index(melodyindex, sizeof(melodyindex) / sizeof(MMLcheckpoint), true);
+ *      melody.seekToBar(12, index);
+ * The positions are byte offsets in the file : the song stored in the sketch must hold
+ *    exactly the same characters (line breaks being replaced by spaces).
+ * The index is only valid for the MMLRESOLUTION it has been built with.
+ *
+ * Build (from the repository root) :
+ *    g++ -O2 -std=gnu++11 -I. -Iextras/host *.cpp extras/host/Arduino.cpp extras/host/index.cpp -o mmlindex
+ *
+ * Usage :
+ *    ./mmlindex [-e every] [-n name] song.mml
+ *      -e : minimum amount of ticks between two checkpoints (default MMLBARTICKS, a bar)
+ *      -n : name of the array (default melodyindex)
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#include "MMLtone.h"
+#include "MMLfileSource.h"
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#define MAXCHECKPOINTS 4096 //most checkpoints printed
+#define INDEXPIN      2
+
+/****************************************************************
+ * I : Program name                                             *
+ * P : Print the usage of the program                           *
+ * O : /                                                        *
+ ****************************************************************/
+static void usage(const char* name){
+  fprintf(stderr, "usage : %s [-e every] [-n name] song.mml\n", name);
+}
+
+int main(int argc, char* argv[]){
+  unsigned int every = MMLBARTICKS;
+  const char* name = "melodyindex";
+
+  //parse the arguments
+  int a = 1;
+  for( ; a < argc && argv[a][0] == '-' && argv[a][1] != '\0' ; a += 2)
+  {
+    if(a + 1 >= argc)
+    {
+      usage(argv[0]);
+      return 1;
+    }
+
+    switch(argv[a][1]){
+      case 'e':
+        every = (unsigned int)strtoul(argv[a + 1], NULL, 10);
+        break;
+
+      case 'n':
+        name = argv[a + 1];
+        break;
+
+      default:
+        usage(argv[0]);
+        return 1;
+    }
+  }
+  if(a + 1 != argc)
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  MMLfileSource source;
+  if(!source.open(argv[a]))
+  {
+    fprintf(stderr, "%s : cannot read the song (65535 bytes at most)\n", argv[a]);
+    return 1;
+  }
+
+  //walk the song once for the checkpoints, then once more for its length
+  std::vector<MMLcheckpoint> checkpoints(MAXCHECKPOINTS);
+  MMLtone melody(INDEXPIN, source);
+  checkpoints.resize(melody.index(checkpoints.data(), checkpoints.size(), every));
+  const unsigned long length = melody.seekToTick((unsigned long)-1);
+
+  printf("//seek index of %s : %zu checkpoints, every %u ticks or more (%lu ticks at %d ticks per whole note)\n",
+         argv[a], checkpoints.size(), every, length, MMLRESOLUTION);
+  printf("const MMLcheckpoint %s[] PROGMEM = {\n", name);
+  for(size_t i = 0 ; i < checkpoints.size() ; i++)
+  {
+    const MMLcheckpoint& c = checkpoints[i];
+    printf("  {%lu, %u, %u, %u, %u}%s\n", c.tick, c.pos, c.octave, c.duration, c.bpm,
+           (i + 1 < checkpoints.size() ? "," : ""));
+  }
+  printf("};\n");
+  return 0;
+}
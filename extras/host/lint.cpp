@@ -0,0 +1,147 @@
+/*
+ * lint.cpp
+ * -----------------------------------------------
+ * Host validator of MML songs.
+ *
+ * Each song file is checked token by token with the rules of the compile-time
+ *    validator (see MMLvalidator.h), and every offending token is reported with
+ *    its offset in the code, its line and column in the file, and the reason.
+ * Line breaks and tabulations are read as spaces, and trailing ones are ignored
+ *    (as MMLfileSource does).
+ *
+ * Build (from the repository root) :
+ *    g++ -O2 -std=gnu++11 -I. -Iextras/host *.cpp extras/host/Arduino.cpp extras/host/lint.cpp -o mmllint
+ *
+ * Usage :
+ *    ./mmllint song.mml [song.mml ...]
+ *    The exit status is 1 if any song is invalid.
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#include "MMLvalidator.h"
+#include <stdio.h>
+#include <vector>
+
+//description of each MMLERR_* reason
+static const char* const reasons[MMLNBERR] = {
+  "valid",
+  "empty token (consecutive spaces or trailing space)",
+  "token too long for the note buffer (truncated)",
+  "unknown note letter",
+  "unexpected character",
+  "duration does not divide MMLRESOLUTION into at least 2 ticks, or dotted beyond 255 ticks",
+  "no octave set before this note",
+  "no duration set before this note (played as a quarter note)",
+  "pitch out of range (below A0 or above B8)",
+  "tempo missing or out of range (1 to MMLMAXTEMPO)",
+  "repeat count out of range (1 to 255), section end without beginning, or section without any note",
+  "section nested deeper than MMLLOOPDEPTH",
+  "section never closed",
+  "unknown envelope parameter (@A, @D, @S or @R), or value missing or above 255",
+};
+
+/****************************************************************
+ * I : Path of the song file                                    *
+ *     Buffer receiving the MML code                            *
+ * P : Read a song, line breaks and tabulations as spaces       *
+ * O : true if read, false otherwise                            *
+ ****************************************************************/
+static bool readSong(const char* path, std::vector<char>& code){
+  FILE* f = fopen(path, "rb");
+  if(!f)
+    return false;
+
+  int c;
+  while((c = fgetc(f)) != EOF)
+    code.push_back((c == '\n' || c == '\r' || c == '\t') ? ' ' : (char)c);
+  fclose(f);
+
+  //trailing spaces are not part of the song
+  while(!code.empty() && code.back() == ' ')
+    code.pop_back();
+
+  return code.size() <= 0xFFFF;
+}
+
+/****************************************************************
+ * I : Path of the song file                                    *
+ *     MML code                                                 *
+ *     Offset of the offending token                            *
+ *     Length of the offending token                            *
+ *     Reason (see MMLERR_*)                                    *
+ * P : Print an error                                           *
+ * O : /                                                        *
+ ****************************************************************/
+static void report(const char* path, const std::vector<char>& code, const unsigned int offset, const unsigned int len, const unsigned char reason){
+  FILE* f = fopen(path, "rb");
+  unsigned int line = 1, column = 1;
+
+  //line and column of the token in the file (offsets are kept by the mapping)
+  for(unsigned int i = 0 ; f && i < offset ; i++)
+  {
+    if(fgetc(f) == '\n')
+    {
+      line++;
+      column = 1;
+    }
+    else
+      column++;
+  }
+  if(f)
+    fclose(f);
+
+  printf("%s:%u:%u: offset %u : '%.*s' : %s\n", path, line, column, offset, (int)len, code.data() + offset, reasons[reason]);
+}
+
+int main(int argc, char* argv[]){
+  unsigned long invalid = 0;
+
+  if(argc < 2)
+  {
+    fprintf(stderr, "usage : %s song.mml [song.mml ...]\n", argv[0]);
+    return 2;
+  }
+
+  for(int a = 1 ; a < argc ; a++)
+  {
+    std::vector<char> code;
+    if(!readSong(argv[a], code))
+    {
+      fprintf(stderr, "%s : cannot read the song (65535 bytes at most)\n", argv[a]);
+      invalid++;
+      continue;
+    }
+
+    //check every token, carrying on after an error to report all of them
+    const unsigned int size = code.size();
+    unsigned int pos = 0, tokens = 0, errors = 0;
+    MMLlint state;
+    while(pos < size)
+    {
+      const MMLtoken token = MMLvalidator::token(code.data(), size, pos);
+      state = state.next(token);
+      if(state.reason != MMLERR_NONE)
+      {
+        report(argv[a], code, token.pos, token.len, state.reason);
+        errors++;
+      }
+      pos += token.len + 1;
+      tokens++;
+    }
+
+    state = state.end(size);
+    if(state.reason != MMLERR_NONE)
+    {
+      report(argv[a], code, state.offset, 0, state.reason);
+      errors++;
+    }
+
+    printf("%s : %u tokens, %u errors\n", argv[a], tokens, errors);
+    if(errors)
+      invalid++;
+  }
+
+  return (invalid ? 1 : 0);
+}
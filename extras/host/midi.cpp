@@ -0,0 +1,785 @@
+/*
+ * midi.cpp
+ * -----------------------------------------------
+ * Converter of Standard MIDI Files (SMF, format 0 or 1) into MML songs or pre-decoded events.
+ *
+ * The notes of each channel are quantised to the tick grid of the library (MMLRESOLUTION
+ *    ticks per whole note) and reduced to a monophonic line, the highest note sounding
+ *    at each tick being kept. Notes out of the pitch table are moved by octaves into it.
+ *    A note re-struck on the same pitch ends the previous one with a clear-cut, and the
+ *    notes left shorter than the two ticks a note lasts at least are merged with the
+ *    previous one. The tempo changes of the file become T tokens (or tempo events),
+ *    written in every song so that each of them can be played alone.
+ *
+ * Each line is printed either :
+ *  - as MML code, the shortest one playing it : the spelling of each note (e.g. C, B# or
+ *    D- for the same pitch), the notes a long one is split into, and whether to repeat
+ *    its octave and duration or rely on the sticky ones are chosen together for the whole
+ *    song, by dynamic programming over the octave and duration in use (see MMLtone::decode()).
+ *    The rests are written as silent notes (out of the pitch table), which the validator
+ *    rejects : songs holding rests are to be stored as they are, not with MML_COMPILE.
+ *  - or as pre-decoded events (see MMLcompiler.h), each note or rest being a single word
+ *    (split every 255 ticks), played with MMLtone(pin, events, count).
+ * Both are decoded back and checked against the line before being printed.
+ * The flash taken by each song in both forms is reported on the error output, so that
+ *    the smallest one can be chosen.
+ *
+ * Build (from the repository root) :
+ *    g++ -O2 -std=gnu++11 -I. -Iextras/host *.cpp extras/host/Arduino.cpp extras/host/midi.cpp -o mmlmidi
+ *
+ * Usage :
+ *    ./mmlmidi [-f mml|events] [-n name] [-c channel] song.mid
+ *      -f : output format, MML code (default) or pre-decoded events
+ *      -n : prefix of the arrays, followed by the channel (default melody)
+ *      -c : only convert this channel (1 to 16, default all of them but the percussions on 10)
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#include "MMLcompiler.h"
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#define MIDICHANNELS  16        //amount of MIDI channels
+#define MIDIDRUMS     9         //channel of the percussions (10, counted from 0)
+#define MIDIA0        21        //MIDI key of A0 (first note of pitches.h)
+#define MAXOCTAVE     9         //highest octave digit
+#define NOOCTAVE      (MAXOCTAVE + 1)  //no octave set yet
+#define MAXEVTTICKS   255       //most ticks held by an event
+#define MAXSEGTICKS   (16 * MMLRESOLUTION)  //most ticks of a note written at once (bounds the memory of the dynamic programming)
+#define LINEWIDTH     96        //most characters of MML printed per line
+#define INFINITE      0xFFFFFFFF
+
+//note read from the file
+typedef struct{
+  unsigned long   start;        //MIDI tick of the note on
+  unsigned long   end;          //MIDI tick of the note off
+  unsigned char   pitch;        //index of the note (see pitches.h)
+}midinote_t;
+
+//tempo change read from the file
+typedef struct{
+  unsigned long   tick;         //MIDI tick of the change
+  unsigned long   usperbeat;    //microseconds per quarter note
+}miditempo_t;
+
+//notes and tempo changes of a whole file
+typedef struct{
+  unsigned int    division;     //MIDI ticks per quarter note
+  unsigned int    folded;       //notes moved by octaves into the pitch table
+  std::vector<midinote_t> notes[MIDICHANNELS];
+  std::vector<miditempo_t> tempos;
+}smf_t;
+
+//note (or rest) of a monophonic line
+typedef struct{
+  unsigned char   pitch;        //index of the note (see pitches.h), MMLEVT_PITCH for a rest
+  unsigned int    ticks;        //amount of ticks
+  bool            cut;          //clear-cut on the last tick (the same pitch is struck again)
+  unsigned int    bpm;          //tempo set right before the note, 0 if unchanged
+}segment_t;
+
+//duration which can be written in a token
+typedef struct{
+  unsigned char   value;        //duration written (e.g. 16)
+  unsigned char   ticks;        //amount of ticks
+  unsigned char   digits;       //amount of characters
+}duration_t;
+
+//token written by the dynamic programming, from the state before it
+typedef struct{
+  unsigned char   prev;         //state before the token
+  unsigned char   octave;       //octave of the token
+  unsigned char   duration;     //index of the duration of the token
+  bool            dotted;       //whether the token is dotted
+}step_t;
+
+static std::vector<duration_t> durations;
+static std::string spellings[NBNOTES + 1][MAXOCTAVE + 1];    //shortest letter and accidental of each pitch (rest last) in each octave
+
+/****************************************************************
+ * Reader of the bytes of a MIDI file, checking their bounds    *
+ ****************************************************************/
+class midiReader
+{
+  private:
+      const std::vector<unsigned char>& m_data;
+      size_t          m_pos;                //index of the next byte
+      bool            m_failed;             //flag indicating whether a read went past the end
+
+  public:
+      midiReader(const std::vector<unsigned char>& data, const size_t pos)
+      :m_data(data), m_pos(pos), m_failed(false)
+      {}
+
+      unsigned char byte(){
+        if(this->m_pos >= this->m_data.size())
+        {
+          this->m_failed = true;
+          return 0;
+        }
+        return this->m_data[this->m_pos++];
+      }
+
+      unsigned char peek() const{
+        return (this->m_pos < this->m_data.size() ? this->m_data[this->m_pos] : 0);
+      }
+
+      //big-endian integer of a few bytes
+      unsigned long word(const unsigned char bytes){
+        unsigned long value = 0;
+        for(unsigned char i = 0 ; i < bytes ; i++)
+          value = (value << 8) | this->byte();
+        return value;
+      }
+
+      //variable-length quantity (7 bits per byte, at most 4 bytes)
+      unsigned long varlen(){
+        unsigned long value = 0;
+        for(unsigned char i = 0 ; i < 4 ; i++)
+        {
+          const unsigned char b = this->byte();
+          value = (value << 7) | (b & 0x7F);
+          if(!(b & 0x80))
+            break;
+        }
+        return value;
+      }
+
+      void skip(const unsigned long bytes){
+        if(bytes > this->m_data.size() - std::min(this->m_pos, this->m_data.size()))
+          this->m_failed = true;
+        this->m_pos = std::min(this->m_pos + bytes, this->m_data.size());
+      }
+
+      size_t pos() const{
+        return this->m_pos;
+      }
+
+      bool failed() const{
+        return this->m_failed;
+      }
+};
+
+/****************************************************************
+ * I : MIDI key                                                 *
+ *     File read                                                *
+ * P : Move a key by octaves into the pitch table               *
+ * O : Index of the note (see pitches.h)                        *
+ ****************************************************************/
+static unsigned char foldKey(const unsigned char key, smf_t& smf){
+  int pitch = (int)key - MIDIA0;
+  if(pitch < NOTE_A0 || pitch > NOTE_B8)
+    smf.folded++;
+  while(pitch < NOTE_A0)
+    pitch += 12;
+  while(pitch > NOTE_B8)
+    pitch -= 12;
+  return (unsigned char)pitch;
+}
+
+/****************************************************************
+ * I : Reader, at the beginning of the track events             *
+ *     Index right after the track                              *
+ *     File read                                                *
+ * P : Read the notes and tempo changes of a track              *
+ * O : true if read, false if malformed                         *
+ ****************************************************************/
+static bool readTrack(midiReader& r, const size_t end, smf_t& smf){
+  long on[MIDICHANNELS][128];
+  unsigned long tick = 0;
+  unsigned char status = 0;
+
+  for(unsigned char c = 0 ; c < MIDICHANNELS ; c++)
+    for(unsigned int k = 0 ; k < 128 ; k++)
+      on[c][k] = -1;
+
+  while(r.pos() < end && !r.failed())
+  {
+    tick += r.varlen();
+
+    //meta events (tempo changes and end of track only) and system exclusive messages
+    const unsigned char first = r.peek();
+    if(first == 0xFF)
+    {
+      r.byte();
+      const unsigned char type = r.byte();
+      const unsigned long length = r.varlen();
+      if(type == 0x51 && length == 3)
+        smf.tempos.push_back({tick, r.word(3)});
+      else
+        r.skip(length);
+      if(type == 0x2F)
+        break;
+      continue;
+    }
+    if(first == 0xF0 || first == 0xF7)
+    {
+      r.byte();
+      r.skip(r.varlen());
+      continue;
+    }
+
+    //channel messages, with running status
+    if(first & 0x80)
+      status = r.byte();
+    if(!(status & 0x80))
+      return false;
+
+    const unsigned char channel = status & 0x0F;
+    const unsigned char type = status & 0xF0;
+    if(type == 0xC0 || type == 0xD0)
+    {
+      r.byte();
+      continue;
+    }
+
+    const unsigned char key = r.byte() & 0x7F;
+    const unsigned char velocity = r.byte();
+    if(type != 0x80 && type != 0x90)
+      continue;
+
+    //a note on ends the same key still held, a note on with a velocity of 0 is a note off
+    if(on[channel][key] >= 0)
+    {
+      smf.notes[channel].push_back({(unsigned long)on[channel][key], tick, foldKey(key, smf)});
+      on[channel][key] = -1;
+    }
+    if(type == 0x90 && velocity)
+      on[channel][key] = (long)tick;
+  }
+
+  //the keys still held end with the track
+  for(unsigned char c = 0 ; c < MIDICHANNELS ; c++)
+    for(unsigned int k = 0 ; k < 128 ; k++)
+      if(on[c][k] >= 0)
+        smf.notes[c].push_back({(unsigned long)on[c][k], tick, foldKey(k, smf)});
+
+  return !r.failed();
+}
+
+/****************************************************************
+ * I : Path of the MIDI file                                    *
+ *     File read                                                *
+ * P : Read the notes and tempo changes of all the tracks       *
+ * O : Error message, NULL if read                              *
+ ****************************************************************/
+static const char* readMidi(const char* path, smf_t& smf){
+  FILE* f = fopen(path, "rb");
+  if(!f)
+    return "cannot open the file";
+
+  std::vector<unsigned char> data;
+  int c;
+  while((c = fgetc(f)) != EOF)
+    data.push_back((unsigned char)c);
+  fclose(f);
+
+  //header chunk
+  midiReader r(data, 0);
+  if(data.size() < 14 || memcmp(data.data(), "MThd", 4))
+    return "not a Standard MIDI File";
+  r.skip(4);
+  const unsigned long headersize = r.word(4);
+  const unsigned int format = r.word(2);
+  const unsigned int tracks = r.word(2);
+  smf.division = r.word(2);
+  smf.folded = 0;
+  if(format > 1)
+    return "only formats 0 and 1 are supported";
+  if(!smf.division || (smf.division & 0x8000))
+    return "SMPTE time divisions are not supported";
+  r.skip(headersize - 6);
+
+  //track chunks (others are skipped)
+  for(unsigned int t = 0 ; t < tracks && r.pos() + 8 <= data.size() ; )
+  {
+    const bool track = !memcmp(data.data() + r.pos(), "MTrk", 4);
+    r.skip(4);
+    const unsigned long length = r.word(4);
+    const size_t end = r.pos() + length;
+    if(end > data.size())
+      return "truncated track";
+
+    if(track)
+    {
+      midiReader events(data, r.pos());
+      if(!readTrack(events, end, smf))
+        return "malformed track";
+      t++;
+    }
+    r.skip(length);
+  }
+
+  //tempo changes of all the tracks, in order (the last one read wins on a tick)
+  std::stable_sort(smf.tempos.begin(), smf.tempos.end(),
+                   [](const miditempo_t& x, const miditempo_t& y){ return x.tick < y.tick; });
+  return NULL;
+}
+
+/****************************************************************
+ * I : MIDI tick                                                *
+ *     MIDI ticks per quarter note                              *
+ * O : Nearest tick of the library                              *
+ ****************************************************************/
+static unsigned long quantise(const unsigned long tick, const unsigned int division){
+  return (unsigned long)(((unsigned long long)tick * MMLTICKSPERBEAT + division / 2) / division);
+}
+
+/****************************************************************
+ * I : Notes of a channel                                       *
+ *     File read                                                *
+ *     Amount of notes dropped (incremented)                    *
+ * P : Quantise the notes, keep the highest one on each tick,   *
+ *     and split the line at the tempo changes                  *
+ * O : Notes and rests of the line                              *
+ ****************************************************************/
+static std::vector<segment_t> monophonic(const std::vector<midinote_t>& notes, const smf_t& smf, unsigned int& dropped){
+  std::vector<segment_t> line;
+
+  //length of the line
+  unsigned long length = 0;
+  for(const midinote_t& n : notes)
+    length = std::max(length, quantise(n.end, smf.division));
+  if(!length)
+    return line;
+
+  //highest note on each tick, and ticks on which it is struck
+  std::vector<int> pitches(length, -1);
+  std::vector<bool> struck(length, false);
+  for(const midinote_t& n : notes)
+  {
+    const unsigned long start = quantise(n.start, smf.division), end = quantise(n.end, smf.division);
+    bool kept = false;
+    for(unsigned long t = start ; t < end ; t++)
+    {
+      if(n.pitch >= pitches[t])
+      {
+        pitches[t] = n.pitch;
+        kept = true;
+        if(t == start)
+          struck[t] = true;
+      }
+    }
+    if(!kept)
+      dropped++;
+  }
+
+  //tempo set on each tick
+  std::vector<unsigned int> bpms(length, 0);
+  for(const miditempo_t& m : smf.tempos)
+  {
+    const unsigned long t = quantise(m.tick, smf.division);
+    const unsigned long bpm = (60000000UL + m.usperbeat / 2) / (m.usperbeat ? m.usperbeat : 1);
+    if(t < length)
+      bpms[t] = (bpm < 1 ? 1 : bpm > MMLMAXTEMPO ? MMLMAXTEMPO : bpm);
+  }
+
+  //split the line on each change of pitch, note struck or tempo change
+  unsigned int bpm = MMLDEFTEMPO;
+  for(unsigned long t = 0 ; t < length ; t++)
+  {
+    const unsigned char pitch = (pitches[t] < 0 ? MMLEVT_PITCH : pitches[t]);
+    const bool strike = (struck[t] && pitch != MMLEVT_PITCH);
+    const bool tempo = (bpms[t] && bpms[t] != bpm);
+
+    if(!line.empty() && line.back().pitch == pitch && !strike && !tempo)
+    {
+      line.back().ticks++;
+      continue;
+    }
+
+    if(!line.empty() && line.back().pitch == pitch && strike)
+      line.back().cut = true;
+    line.push_back({pitch, 1, false, (tempo ? bpms[t] : 0)});
+    if(tempo)
+      bpm = bpms[t];
+  }
+
+  //merge the segments of a single tick (a note lasts two ticks at least) with the previous one,
+  //  or with the next one if there is none, or if it changes the tempo
+  std::vector<segment_t> merged;
+  for(size_t i = 0 ; i < line.size() ; i++)
+  {
+    segment_t s = line[i];
+    if(s.ticks == 1)
+    {
+      if(s.pitch != MMLEVT_PITCH)
+        dropped++;
+
+      if(!merged.empty() && (!s.bpm || i + 1 == line.size()))
+      {
+        merged.back().ticks++;
+        merged.back().cut = s.cut;
+        continue;
+      }
+      if(i + 1 < line.size())
+      {
+        line[i + 1].ticks++;
+        if(!line[i + 1].bpm)
+          line[i + 1].bpm = s.bpm;
+        continue;
+      }
+
+      //a song of a single tick is lengthened
+      s.ticks = 2;
+    }
+
+    //a note (or rest) going on after a merge is a single one
+    if(!merged.empty() && merged.back().pitch == s.pitch && !merged.back().cut && !s.bpm)
+      merged.back().ticks += s.ticks;
+    else
+      merged.push_back(s);
+  }
+
+  //split the longest notes (rests) in pieces, without leaving a single tick
+  line.clear();
+  for(segment_t& s : merged)
+  {
+    for( ; s.ticks > MAXSEGTICKS ; s.bpm = 0)
+    {
+      const unsigned int t = (s.ticks - MAXSEGTICKS == 1 ? MAXSEGTICKS - 1 : MAXSEGTICKS);
+      line.push_back({s.pitch, t, false, s.bpm});
+      s.ticks -= t;
+    }
+    line.push_back(s);
+  }
+  return line;
+}
+
+/****************************************************************
+ * I : /                                                        *
+ * P : List the durations which can be written, and the         *
+ *     shortest spelling of each pitch in each octave           *
+ * O : /                                                        *
+ ****************************************************************/
+static void buildTables(){
+  for(unsigned int d = 1 ; d < 100 ; d++)
+  {
+    if(MMLtoken::playable(d) && MMLtoken::length(d) * d == MMLRESOLUTION)
+      durations.push_back({(unsigned char)d, MMLtoken::length(d), (unsigned char)(d < 10 ? 1 : 2)});
+  }
+
+  static const char* const accidentals[] = {"", "#", "-"};
+  for(const char* letter = "ABCDEFG" ; *letter ; letter++)
+  {
+    for(const char* accidental : accidentals)
+    {
+      const std::string text = std::string(1, *letter) + accidental;
+      const MMLtoken token(text.c_str(), 0, text.size());
+      for(unsigned char oct = 0 ; oct <= MAXOCTAVE ; oct++)
+      {
+        const unsigned char pitch = token.pitch(oct);
+        std::string& best = spellings[pitch > NOTE_B8 ? NBNOTES : pitch][oct];
+        if(best.empty() || text.size() < best.size())
+          best = text;
+      }
+    }
+  }
+}
+
+/****************************************************************
+ * I : Index of the duration                                    *
+ *     Whether the token is dotted                              *
+ * O : Amount of ticks of a token (as MMLtone::decode())        *
+ ****************************************************************/
+static unsigned int tokenTicks(const unsigned char d, const bool dotted){
+  const unsigned int t = durations[d].ticks;
+  return (dotted ? std::min(t + (t >> 1), 0xFFu) : t);
+}
+
+/****************************************************************
+ * I : Notes and rests of the line                              *
+ * O : Shortest MML code playing them                           *
+ ****************************************************************/
+static std::string writeMML(const std::vector<segment_t>& line){
+  //state : octave (NOOCTAVE if none yet) and index of the duration (durations.size() if none yet)
+  const unsigned int nbdur = durations.size() + 1;
+  const unsigned int nbstates = (NOOCTAVE + 1) * nbdur;
+  std::vector<unsigned long> cost(nbstates, INFINITE);
+  std::vector<std::vector<step_t> > steps(line.size());
+  cost[NOOCTAVE * nbdur + durations.size()] = 0;
+
+  for(size_t i = 0 ; i < line.size() ; i++)
+  {
+    const segment_t& s = line[i];
+    const std::string* spelling = spellings[s.pitch == MMLEVT_PITCH ? NBNOTES : s.pitch];
+
+    //cost[k][state] : fewest characters having written k ticks of the segment
+    std::vector<unsigned long> g((s.ticks + 1) * nbstates, INFINITE);
+    steps[i].assign((s.ticks + 1) * nbstates, step_t());
+    std::copy(cost.begin(), cost.end(), g.begin());
+
+    for(unsigned int k = 0 ; k < s.ticks ; k++)
+    {
+      for(unsigned int state = 0 ; state < nbstates ; state++)
+      {
+        const unsigned long before = g[k * nbstates + state];
+        if(before == INFINITE)
+          continue;
+
+        const unsigned char octave = state / nbdur, duration = state % nbdur;
+        for(unsigned char o = 0 ; o <= MAXOCTAVE ; o++)
+        {
+          if(spelling[o].empty())
+            continue;
+
+          for(unsigned char d = 0 ; d < durations.size() ; d++)
+          {
+            for(unsigned char dotted = 0 ; dotted < 2 ; dotted++)
+            {
+              const unsigned int t = tokenTicks(d, dotted);
+              if(k + t > s.ticks || s.ticks - k - t == 1)
+                continue;
+
+              //octave, spelling, duration, dot, clear-cut and separator
+              const unsigned long c = before + (o != octave) + spelling[o].size() + (d != duration ? durations[d].digits : 0)
+                                      + dotted + (s.cut && k + t == s.ticks) + 1;
+              const unsigned int next = (k + t) * nbstates + o * nbdur + d;
+              if(c < g[next])
+              {
+                g[next] = c;
+                steps[i][next] = {(unsigned char)state, o, d, (bool)dotted};
+              }
+            }
+          }
+        }
+      }
+    }
+    std::copy(g.begin() + s.ticks * nbstates, g.end(), cost.begin());
+  }
+
+  //walk the tokens back from the cheapest final state
+  unsigned int state = std::min_element(cost.begin(), cost.end()) - cost.begin();
+  std::vector<std::string> tokens;
+  for(size_t i = line.size() ; i-- > 0 ; )
+  {
+    const segment_t& s = line[i];
+    for(unsigned int k = s.ticks ; k > 0 ; )
+    {
+      const step_t& st = steps[i][k * nbstates + state];
+      const unsigned char octave = st.prev / nbdur, duration = st.prev % nbdur;
+      std::string token;
+      if(st.octave != octave)
+        token += (char)('0' + st.octave);
+      token += spellings[s.pitch == MMLEVT_PITCH ? NBNOTES : s.pitch][st.octave];
+      if(st.duration != duration)
+        token += std::to_string(durations[st.duration].value);
+      if(st.dotted)
+        token += '.';
+      if(s.cut && k == s.ticks)
+        token += '/';
+      tokens.push_back(token);
+
+      k -= tokenTicks(st.duration, st.dotted);
+      state = st.prev;
+    }
+    if(s.bpm)
+      tokens.push_back("T" + std::to_string(s.bpm));
+  }
+
+  std::string code;
+  for(size_t i = tokens.size() ; i-- > 0 ; )
+    code += tokens[i] + (i ? " " : "");
+  return code;
+}
+
+/****************************************************************
+ * I : Notes and rests of the line                              *
+ * O : Pre-decoded events playing them (see MMLcompiler.h)      *
+ ****************************************************************/
+static std::vector<uint16_t> writeEvents(const std::vector<segment_t>& line){
+  std::vector<uint16_t> events;
+  for(const segment_t& s : line)
+  {
+    if(s.bpm)
+      events.push_back(MMLEVT_TEMPO | (s.bpm << MMLEVT_TSHIFT));
+
+    //split every 255 ticks, without leaving a single tick
+    for(unsigned int left = s.ticks ; left ; )
+    {
+      const unsigned int t = (left <= MAXEVTTICKS ? left : left - MAXEVTTICKS == 1 ? MAXEVTTICKS - 1 : MAXEVTTICKS);
+      left -= t;
+      events.push_back(s.pitch | (t << MMLEVT_TSHIFT) | (s.cut && !left ? MMLEVT_CUT : 0));
+    }
+  }
+  return events;
+}
+
+/****************************************************************
+ * I : MML code                                                 *
+ * O : Events decoded from it, as MMLtone does                  *
+ ****************************************************************/
+static std::vector<uint16_t> decodeMML(const std::string& code){
+  std::vector<uint16_t> events;
+  const unsigned int size = code.size() + 1;
+  unsigned char octave = 0, duration = MMLDEFTICKS;
+  for(unsigned int pos = 0 ; pos < size ; )
+  {
+    const unsigned int length = MMLcompiler::length(code.c_str(), size, pos);
+    const MMLtoken token(code.c_str(), pos, length);
+    events.push_back(token.event(octave, duration));
+    octave = token.octave(octave);
+    duration = token.duration(duration);
+    pos += length;
+  }
+  return events;
+}
+
+/****************************************************************
+ * I : Events                                                   *
+ * O : Pitch played on each tick (clear-cut on the last one),   *
+ *     tempo changes as 0x10000 | bpm                           *
+ ****************************************************************/
+static std::vector<uint32_t> trace(const std::vector<uint16_t>& events){
+  std::vector<uint32_t> ticks;
+  for(uint16_t e : events)
+  {
+    if((e & MMLEVT_PITCH) == MMLEVT_TEMPO)
+    {
+      ticks.push_back(0x10000 | (e >> MMLEVT_TSHIFT));
+      continue;
+    }
+
+    const unsigned int t = (e & MMLEVT_TICKS) >> MMLEVT_TSHIFT;
+    for(unsigned int i = 0 ; i < t ; i++)
+      ticks.push_back((e & MMLEVT_PITCH) | (i + 1 == t ? (e & MMLEVT_CUT) : 0));
+  }
+  return ticks;
+}
+
+/****************************************************************
+ * I : Program name                                             *
+ * P : Print the usage of the program                           *
+ * O : /                                                        *
+ ****************************************************************/
+static void usage(const char* name){
+  fprintf(stderr, "usage : %s [-f mml|events] [-n name] [-c channel] song.mid\n", name);
+}
+
+int main(int argc, char* argv[]){
+  bool events = false;
+  const char* name = "melody";
+  int only = -1;
+
+  //parse the arguments
+  int a = 1;
+  for( ; a < argc && argv[a][0] == '-' && argv[a][1] != '\0' ; a += 2)
+  {
+    if(a + 1 >= argc)
+    {
+      usage(argv[0]);
+      return 1;
+    }
+
+    switch(argv[a][1]){
+      case 'f':
+        events = !strcmp(argv[a + 1], "events");
+        break;
+
+      case 'n':
+        name = argv[a + 1];
+        break;
+
+      case 'c':
+        only = atoi(argv[a + 1]) - 1;
+        if(only < 0 || only >= MIDICHANNELS)
+        {
+          usage(argv[0]);
+          return 1;
+        }
+        break;
+
+      default:
+        usage(argv[0]);
+        return 1;
+    }
+  }
+  if(a + 1 != argc)
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  smf_t smf;
+  const char* error = readMidi(argv[a], smf);
+  if(error)
+  {
+    fprintf(stderr, "%s : %s\n", argv[a], error);
+    return 1;
+  }
+  buildTables();
+
+  fprintf(stderr, "%s : %u ticks per quarter note, quantised to %d ticks per whole note\n", argv[a], smf.division, MMLRESOLUTION);
+  fprintf(stderr, "channel    notes  dropped    ticks   MML (bytes)   events (bytes)\n");
+  unsigned long totalmml = 0, totalevents = 0;
+  for(int c = 0 ; c < MIDICHANNELS ; c++)
+  {
+    if(smf.notes[c].empty() || (only >= 0 ? c != only : c == MIDIDRUMS))
+      continue;
+
+    unsigned int dropped = 0;
+    const std::vector<segment_t> line = monophonic(smf.notes[c], smf, dropped);
+    if(line.empty())
+      continue;
+
+    //write the line in both forms, and check that both play it
+    const std::string code = writeMML(line);
+    const std::vector<uint16_t> words = writeEvents(line);
+    const std::vector<uint32_t> expected = trace(words);
+    if(trace(decodeMML(code)) != expected)
+    {
+      fprintf(stderr, "channel %d : the MML code written does not play the line\n", c + 1);
+      return 1;
+    }
+
+    unsigned long ticks = 0;
+    for(const segment_t& s : line)
+      ticks += s.ticks;
+    const unsigned long mmlsize = code.size() + 1, eventsize = words.size() * sizeof(uint16_t);
+    totalmml += mmlsize;
+    totalevents += eventsize;
+    fprintf(stderr, "%7d %8zu %8u %8lu %11lu%s %14lu%s\n", c + 1, smf.notes[c].size(), dropped, ticks,
+            mmlsize, (mmlsize <= eventsize ? "*" : " "), eventsize, (eventsize < mmlsize ? "*" : " "));
+
+    //print the song
+    printf("//channel %d of %s : %lu ticks at %d ticks per whole note\n", c + 1, argv[a], ticks, MMLRESOLUTION);
+    if(events)
+    {
+      printf("const uint16_t %s%d[] PROGMEM = {", name, c + 1);
+      for(size_t i = 0 ; i < words.size() ; i++)
+        printf("%s0x%04X%s", (i % 12 ? " " : "\n  "), words[i], (i + 1 < words.size() ? "," : ""));
+      printf("\n};\n");
+    }
+    else
+    {
+      printf("const char %s%d[] PROGMEM = {", name, c + 1);
+      for(size_t pos = 0 ; pos < code.size() ; )
+      {
+        //break the lines after a separator
+        size_t end = code.size();
+        if(end - pos > LINEWIDTH)
+        {
+          end = code.rfind(' ', pos + LINEWIDTH);
+          if(end == std::string::npos || end < pos)
+            end = code.find(' ', pos);
+          end = (end == std::string::npos ? code.size() : end + 1);
+        }
+        printf("\n  \"%s\"", code.substr(pos, end - pos).c_str());
+        pos = end;
+      }
+      printf("\n};\n");
+    }
+  }
+
+  fprintf(stderr, "total %30lu %15lu   (* smallest)\n", totalmml, totalevents);
+  if(smf.folded)
+    fprintf(stderr, "%u notes out of A0 - B8 moved by octaves\n", smf.folded);
+  return 0;
+}
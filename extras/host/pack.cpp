@@ -0,0 +1,127 @@
+/*
+ * pack.cpp
+ * -----------------------------------------------
+ * Packer of MML songs into PROGMEM arrays of packed tokens (see MMLpacked.h).
+ *
+ * Each song is compiled into events with the rules of MMLcompiler.h, packed (see MMLpacker.h),
+ *    then unpacked again with the decoder of the library to check that both hold the same events.
+ *    The arrays are printed on the standard output, to be pasted in the sketch :
+ *      const uint8_t melodypacked[] PROGMEM = { ... };
+ *      MMLtone melody = MMLtone(12, melodypacked, sizeof(melodypacked));
+ * The flash taken by each song as MML code, pre-decoded events and packed tokens is reported
+ *    on the error output.
+ * Packed songs are only valid for the MMLRESOLUTION they have been packed with.
+ *
+ * Build (from the repository root) :
+ *    g++ -O2 -std=gnu++11 -I. -Iextras/host *.cpp extras/host/Arduino.cpp extras/host/pack.cpp -o mmlpack
+ *
+ * Usage :
+ *    ./mmlpack [-n name] song.mml [song.mml ...]
+ *      -n : name of the array (default melodypacked), followed by its number if several songs are given
+ *    Each song file holds MML code (line breaks are treated as spaces), up to 65535 bytes.
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#include "MMLpacker.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#define BYTESPERLINE  16        //bytes printed per line
+
+/****************************************************************
+ * I : Path of the song file                                    *
+ *     Buffer receiving the MML code                            *
+ * P : Read a song, line breaks and tabulations as spaces       *
+ * O : true if read, false otherwise                            *
+ ****************************************************************/
+static bool readSong(const char* path, std::vector<char>& code){
+  FILE* f = fopen(path, "rb");
+  if(!f)
+    return false;
+
+  int c;
+  while((c = fgetc(f)) != EOF)
+    code.push_back((c == '\n' || c == '\r' || c == '\t') ? ' ' : (char)c);
+  fclose(f);
+
+  //trailing spaces are not part of the song
+  while(!code.empty() && code.back() == ' ')
+    code.pop_back();
+
+  return code.size() < 0xFFFF;
+}
+
+/****************************************************************
+ * I : Packed song                                              *
+ * O : Events unpacked by the library (see MMLunpack())         *
+ ****************************************************************/
+static std::vector<uint16_t> unpack(const std::vector<uint8_t>& packed){
+  std::vector<uint16_t> events;
+  unsigned char pitch = 0, duration = MMLDEFTICKS;
+  for(unsigned int pos = 0 ; pos < packed.size() ; )
+    events.push_back(MMLunpack(packed.data(), packed.size(), pos, pitch, duration));
+  return events;
+}
+
+int main(int argc, char* argv[]){
+  const char* name = "melodypacked";
+  unsigned long totalcode = 0, totalevents = 0, totalpacked = 0;
+
+  int a = 1;
+  if(a + 1 < argc && !strcmp(argv[a], "-n"))
+  {
+    name = argv[a + 1];
+    a += 2;
+  }
+  if(a >= argc)
+  {
+    fprintf(stderr, "usage : %s [-n name] song.mml [song.mml ...]\n", argv[0]);
+    return 1;
+  }
+
+  fprintf(stderr, "song                              MML   events   packed   (bytes, %d ticks per whole note)\n", MMLRESOLUTION);
+  for(int s = a ; s < argc ; s++)
+  {
+    //the code is stored with its final '\0', as with sizeof()
+    std::vector<char> code;
+    if(!readSong(argv[s], code))
+    {
+      fprintf(stderr, "%s : cannot read the song (65535 bytes at most)\n", argv[s]);
+      return 1;
+    }
+    code.push_back('\0');
+
+    const std::vector<uint16_t> events = MMLcompile(code.data(), code.size());
+    const std::vector<uint8_t> packed = MMLpack(events.data(), events.size());
+    if(unpack(packed) != events)
+    {
+      fprintf(stderr, "%s : the packed song does not hold the events of the code\n", argv[s]);
+      return 1;
+    }
+
+    const unsigned long eventsize = events.size() * sizeof(uint16_t);
+    totalcode += code.size();
+    totalevents += eventsize;
+    totalpacked += packed.size();
+    fprintf(stderr, "%-28s %8zu %8lu %8zu   (%.2fx smaller than MML)\n",
+            argv[s], code.size(), eventsize, packed.size(), (double)code.size() / packed.size());
+
+    //print the array
+    printf("//%s packed : %zu bytes (%zu bytes of MML code)\n", argv[s], packed.size(), code.size());
+    if(argc - a > 1)
+      printf("const uint8_t %s%d[] PROGMEM = {", name, s - a + 1);
+    else
+      printf("const uint8_t %s[] PROGMEM = {", name);
+    for(size_t i = 0 ; i < packed.size() ; i++)
+      printf("%s0x%02X%s", (i % BYTESPERLINE ? " " : "\n  "), packed[i], (i + 1 < packed.size() ? "," : ""));
+    printf("\n};\n");
+  }
+
+  if(argc - a > 1)
+    fprintf(stderr, "%-28s %8lu %8lu %8lu   (%.2fx smaller than MML)\n",
+            "total", totalcode, totalevents, totalpacked, (double)totalcode / totalpacked);
+  return 0;
+}
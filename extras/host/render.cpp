@@ -0,0 +1,296 @@
+/*
+ * render.cpp
+ * -----------------------------------------------
+ * Offline renderer of MML songs into PCM audio (WAV or raw).
+ *
+ * Each song is played by an MMLtone, driven by an MMLsequencer exactly as the timer
+ *    ISR would, and the tone()/noTone() calls are turned into a square wave, as a
+ *    buzzer would play it (clear-cuts and dotted durations included).
+ * Several songs given at once are played as simultaneous voices and mixed together.
+ * Each voice plays through an MMLenvelope clocked MMLCLOCKHZ times per second of audio,
+ *    the volume it computes scaling the amplitude of the wave (see @A, @D, @S and @R).
+ *
+ * The songs are read from their files note by note (see MMLfileSource.h), and the
+ *    audio is rendered and written one tick at a time, so songs of any length
+ *    can be rendered without holding them in memory, at hundreds of times real time.
+ *
+ * Build (from the repository root) :
+ *    g++ -O2 -std=gnu++11 -I. -Iextras/host *.cpp extras/host/Arduino.cpp extras/host/render.cpp -o mmlrender
+ *
+ * Usage :
+ *    ./mmlrender [-r rate] [-t bpm] [-a amplitude] [-f wav|raw] [-o output] song.mml [song.mml ...]
+ *      -r : sample rate (in Hz, default 44100)
+ *      -t : tempo at the start of the songs (in beats per minute, default 120), then changed by their T commands
+ *      -a : amplitude of the square wave (0 to 32767, default 8000)
+ *      -f : output format, signed 16 bits mono WAV (default) or raw PCM
+ *      -o : output file (default out.wav), - for the standard output
+ *    Each song file holds MML code (line breaks are treated as spaces), up to 65535 bytes.
+ *    The length of each tick follows the tempo of the first song, as the timer does
+ *    (see MMLsequencer::onTimer()).
+ *
+ * Check (from the repository root), against the golden render of a tempo change :
+ *    ./mmlrender -r 1000 -f raw -o tempo.raw extras/host/golden/tempo.mml && cmp tempo.raw extras/host/golden/tempo.1000.raw
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#include "MMLtone.h"
+#include "MMLsequencer.h"
+#include "MMLfileSource.h"
+#include "MMLenvelope.h"
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#define FIRSTPIN      2
+
+typedef struct{
+  unsigned long rate;       //sample rate (in Hz)
+  unsigned int  bpm;        //tempo (in beats per minute)
+  unsigned int  amplitude;  //amplitude of the square wave
+  bool          raw;        //flag indicating whether to write raw PCM instead of WAV
+  const char*   output;     //output file name, - for stdout
+}options_t;
+
+/****************************************************************
+ * tone() output keeping the volume given by the envelope       *
+ ****************************************************************/
+class volumeOutput : public MMLtoneOutput
+{
+  private:
+      unsigned char   m_level;              //volume (0 to 255)
+
+  public:
+      volumeOutput()
+      :m_level(0xFF)
+      {}
+
+      void volume(const unsigned char pin, const unsigned char level){
+        (void)pin;
+        this->m_level = level;
+      }
+
+      unsigned char level() const{
+        return this->m_level;
+      }
+};
+
+/****************************************************************
+ * I : File to write to                                         *
+ *     Value to write                                           *
+ *     Amount of bytes to write                                 *
+ * P : Write a little-endian integer                            *
+ * O : /                                                        *
+ ****************************************************************/
+static void writeLE(FILE* f, const unsigned long value, const unsigned char bytes){
+  for(unsigned char i = 0 ; i < bytes ; i++)
+    fputc((value >> (8 * i)) & 0xFF, f);
+}
+
+/****************************************************************
+ * I : File to write to                                         *
+ *     Sample rate (in Hz)                                      *
+ *     Amount of bytes of audio data (0xFFFFFFFF if unknown)    *
+ * P : Write the header of a 16 bits mono WAV file              *
+ * O : /                                                        *
+ ****************************************************************/
+static void writeWavHeader(FILE* f, const unsigned long rate, const unsigned long datasize){
+  fwrite("RIFF", 1, 4, f);
+  writeLE(f, (datasize == 0xFFFFFFFF ? datasize : datasize + 36), 4);
+  fwrite("WAVEfmt ", 1, 8, f);
+  writeLE(f, 16, 4);          //size of the format chunk
+  writeLE(f, 1, 2);           //PCM
+  writeLE(f, 1, 2);           //mono
+  writeLE(f, rate, 4);
+  writeLE(f, rate * 2, 4);    //bytes per second
+  writeLE(f, 2, 2);           //bytes per sample frame
+  writeLE(f, 16, 2);          //bits per sample
+  fwrite("data", 1, 4, f);
+  writeLE(f, datasize, 4);
+}
+
+/****************************************************************
+ * I : Program name                                             *
+ * P : Print the usage of the program                           *
+ * O : /                                                        *
+ ****************************************************************/
+static void usage(const char* name){
+  fprintf(stderr, "usage : %s [-r rate] [-t bpm] [-a amplitude] [-f wav|raw] [-o output] song.mml [song.mml ...]\n", name);
+}
+
+int main(int argc, char* argv[]){
+  options_t opt = {44100, 120, 8000, false, "out.wav"};
+  std::vector<MMLfileSource> sources;
+  std::vector<MMLtone> voices;
+  std::vector<volumeOutput> outputs;
+  std::vector<MMLenvelope> envelopes;
+  MMLsequencer sequencer;
+
+  //parse the arguments
+  int a = 1;
+  for( ; a < argc && argv[a][0] == '-' && argv[a][1] != '\0' ; a += 2)
+  {
+    if(a + 1 >= argc)
+    {
+      usage(argv[0]);
+      return 1;
+    }
+
+    switch(argv[a][1]){
+      case 'r':
+        opt.rate = strtoul(argv[a + 1], NULL, 10);
+        break;
+
+      case 't':
+        opt.bpm = (unsigned int)strtoul(argv[a + 1], NULL, 10);
+        break;
+
+      case 'a':
+        opt.amplitude = (unsigned int)strtoul(argv[a + 1], NULL, 10);
+        break;
+
+      case 'f':
+        opt.raw = !strcmp(argv[a + 1], "raw");
+        break;
+
+      case 'o':
+        opt.output = argv[a + 1];
+        break;
+
+      default:
+        usage(argv[0]);
+        return 1;
+    }
+  }
+  if(a >= argc || !opt.rate || !opt.bpm || opt.amplitude > 32767)
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  //open the songs, one voice per song
+  if(argc - a > MAXVOICES)
+  {
+    fprintf(stderr, "at most %d songs can be played together\n", MAXVOICES);
+    return 1;
+  }
+  sources.resize(argc - a);
+  for(int s = 0 ; a + s < argc ; s++)
+  {
+    if(!sources[s].open(argv[a + s]))
+    {
+      fprintf(stderr, "%s : cannot read the song (65535 bytes at most)\n", argv[a + s]);
+      return 1;
+    }
+    voices.push_back(MMLtone(FIRSTPIN + s, sources[s]));
+    voices.back().setTempo(opt.bpm);
+  }
+
+  //the envelopes point to the outputs, which are not to be moved afterwards
+  outputs.resize(voices.size());
+  for(unsigned int v = 0 ; v < voices.size() ; v++)
+    envelopes.push_back(MMLenvelope(outputs[v]));
+  for(unsigned int v = 0 ; v < voices.size() ; v++)
+  {
+    voices[v].setOutput(envelopes[v]);
+    sequencer.add(voices[v]);
+  }
+
+  //open the output
+  const bool tostdout = !strcmp(opt.output, "-");
+  FILE* out = (tostdout ? stdout : fopen(opt.output, "wb"));
+  if(!out)
+  {
+    fprintf(stderr, "%s : cannot open the output\n", opt.output);
+    return 1;
+  }
+  if(!opt.raw)
+    writeWavHeader(out, opt.rate, 0xFFFFFFFF);
+
+  //play the song tick by tick, and render each tick once the tones are updated
+  //  (samples per tick = rate * 60 / (bpm * MMLTICKSPERBEAT), the remainder is carried over)
+  const unsigned long long num = (unsigned long long)opt.rate * 60;
+  unsigned long long den = (unsigned long long)opt.bpm * MMLTICKSPERBEAT;
+  const int amplitude = opt.amplitude / voices.size();
+  std::vector<uint32_t> phases(voices.size(), 0), increments(voices.size(), 0);
+  std::vector<unsigned int> frequencies(voices.size(), 0);
+  std::vector<unsigned long> clocks(voices.size(), 0);
+  std::vector<int16_t> samples;
+  unsigned long long ticks = 0, frames = 0, remainder = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  sequencer.setup();
+  sequencer.start();
+  while(!sequencer.finished())
+  {
+    sequencer.onTick();
+    if(sequencer.finished())
+      break;
+
+    //follow the tempo changes of the first voice, from this tick on
+    //  (the remainder is scaled to the new length of a tick)
+    const unsigned long long bpmden = (unsigned long long)voices[0].tempo() * MMLTICKSPERBEAT;
+    if(bpmden != den)
+    {
+      remainder = (remainder * bpmden) / den;
+      den = bpmden;
+    }
+
+    const unsigned long nbsamples = (remainder + num) / den;
+    remainder = (remainder + num) % den;
+    samples.assign(nbsamples, 0);
+
+    for(unsigned int v = 0 ; v < voices.size() ; v++)
+    {
+      for(unsigned long i = 0 ; i < nbsamples ; i++)
+      {
+        //envelope clocked MMLCLOCKHZ times per second (it may mute the voice at the end of a release)
+        clocks[v] += MMLCLOCKHZ;
+        if(clocks[v] >= opt.rate)
+        {
+          clocks[v] -= opt.rate;
+          envelopes[v].clock();
+        }
+
+        const unsigned int frequency = hostPinTone[FIRSTPIN + v];
+        if(!frequency)
+          continue;
+
+        //32 bits phase accumulator, the MSB gives the square wave
+        if(frequency != frequencies[v])
+        {
+          frequencies[v] = frequency;
+          increments[v] = (uint32_t)(((unsigned long long)frequency << 32) / opt.rate);
+        }
+        const int level = (amplitude * outputs[v].level()) / 255;
+        samples[i] += (phases[v] & 0x80000000 ? -level : level);
+        phases[v] += increments[v];
+      }
+    }
+
+    for(unsigned long i = 0 ; i < nbsamples ; i++)
+      writeLE(out, (uint16_t)samples[i], 2);
+    frames += nbsamples;
+    ticks++;
+  }
+  sequencer.stop();
+
+  //patch the sizes in the header if the output can be rewound
+  if(!opt.raw && !tostdout)
+  {
+    fseek(out, 0, SEEK_SET);
+    writeWavHeader(out, opt.rate, frames * 2);
+  }
+  if(!tostdout)
+    fclose(out);
+
+  const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  const double duration = (double)frames / opt.rate;
+  fprintf(stderr, "%llu ticks, %.2f s of audio rendered in %.4f s (%.0fx real time)\n",
+          ticks, duration, elapsed, (elapsed > 0 ? duration / elapsed : 0));
+  return 0;
+}
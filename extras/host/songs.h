@@ -0,0 +1,60 @@
+/*
+ * songs.h
+ * -----------------------------------------------
+ * Corpus of MML songs shared by the host tools (benchmark, renderer, ...)
+ *
+ * The songs are chosen to cover all the paths of the decoder :
+ *    octave changes, sharps and flats, dotted notes, clear-cuts,
+ *    long notes and fast 1/32 passages, tempo changes, nested repeated
+ *    sections and envelope parameters.
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#ifndef SONGS_H_INCLUDED
+#define SONGS_H_INCLUDED
+
+#include <Arduino.h>
+#include "MMLcompiler.h"
+
+typedef struct{
+  const char*     name;   //name of the song
+  const char*     code;   //PROGMEM address of the MML code
+  unsigned int    size;   //size (in bytes) of the MML code
+  const uint16_t* events; //PROGMEM address of the pre-decoded events (see MMLcompiler.h)
+  unsigned int    count;  //amount of pre-decoded events
+}song_t;
+
+#define SONG_MELODY "4D4 G2 G8 B8 A8 B8 G2./ G4 A2/ A8/ A8 G8 A8 B4 G4/ G4 D4 G2 G8 B8 A8 B8 G2. B4 A4 5C4 4B4 A4 G4"
+#define SONG_SCALE  "4C8 D8 E8 F8 G8 A8 B8 5C8 4B8 A8 G8 F8 E8 D8 C2"
+#define SONG_ELISE  "5E16 D#16 E16 D#16 E16 4B16 5D16 C16 4A8. 3C16 E16 A16 B8. E16 G#16 B16 5C8. 4E16 5E16 D#16 E16 D#16 E16 4B16 5D16 C16 4A8."
+#define SONG_RUN    "6C32 D32 E32 F32 G32 A32 B32 7C32 6B-32 A-32 G32 F32 E-32 D32 C32 5B32 6C16/ C16/ C16/ C16/ 5G32 A32 B32 6C32 D32 E32 F32 G32 A4."
+#define SONG_DRONE  "2A1 G1. E2/ A1 1A1. 2C2./ A1"
+#define SONG_LOOPS  "T140 @A2 @D6 @S180 @R4 4C8 [ E8 G8 [ 5C16 4B16/ ]3 ]2 T100 A4./ [ F#8 E-8 ] D2."
+
+const char song_melody[] PROGMEM = {SONG_MELODY};
+const char song_scale[] PROGMEM = {SONG_SCALE};
+const char song_elise[] PROGMEM = {SONG_ELISE};
+const char song_run[] PROGMEM = {SONG_RUN};
+const char song_drone[] PROGMEM = {SONG_DRONE};
+const char song_loops[] PROGMEM = {SONG_LOOPS};
+
+MML_COMPILE(events_melody, SONG_MELODY);
+MML_COMPILE(events_scale, SONG_SCALE);
+MML_COMPILE(events_elise, SONG_ELISE);
+MML_COMPILE(events_run, SONG_RUN);
+MML_COMPILE(events_drone, SONG_DRONE);
+MML_COMPILE(events_loops, SONG_LOOPS);
+
+const song_t songs[] = {
+  {"melody", song_melody, sizeof(song_melody), events_melody::events, events_melody::count},
+  {"scale", song_scale, sizeof(song_scale), events_scale::events, events_scale::count},
+  {"elise", song_elise, sizeof(song_elise), events_elise::events, events_elise::count},
+  {"run", song_run, sizeof(song_run), events_run::events, events_run::count},
+  {"drone", song_drone, sizeof(song_drone), events_drone::events, events_drone::count},
+  {"loops", song_loops, sizeof(song_loops), events_loops::events, events_loops::count},
+};
+
+#define NBSONGS (sizeof(songs) / sizeof(songs[0]))
+#endif
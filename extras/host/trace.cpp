@@ -0,0 +1,429 @@
+/*
+ * trace.cpp
+ * -----------------------------------------------
+ * Regression suite of the playback timing, against golden event traces.
+ *
+ * Each song of the corpus (songs.h) is played exactly as the timer ISR does
+ *    (getNextNote() then onTick() on each tick), and everything it does is recorded
+ *    with its tick, one line per event :
+ *      <tick> on <frequency>     tone()
+ *      <tick> off                noTone() (clear-cuts and end of the song)
+ *      <tick> env <param> <value> envelope parameter set (see MMLENV_* in MMLoutput.h)
+ *      <tick> tempo <bpm>        tempo changed by a T command
+ *      <tick> end                amount of ticks played
+ * The trace of the MML code is compared with the golden trace checked in for that song
+ *    and resolution (extras/host/golden/<song>.<MMLRESOLUTION>.trace), then so are the traces
+ *    of its pre-decoded events (see MMLcompiler.h) and of its packed tokens (see MMLpacked.h).
+ *    The first difference of each song is printed, and any difference fails the suite.
+ * Once the traces match, the throughput of the MML code is measured on the same corpus
+ *    (see bench.cpp for the latencies).
+ *
+ * A playlist of two songs (PLAYLIST_FIRST then PLAYLIST_SECOND) is traced the same way
+ *    (extras/host/golden/playlist.<MMLRESOLUTION>.trace), on each path. Its trace must also be
+ *    the one of the first song without its end, followed by the one of the second song
+ *    shifted to the tick the last note of the first one ends (a song alone only notices it
+ *    has finished on the following tick) : no tick is missing or added at the boundary.
+ *
+ * A change to the decoder is expected to leave the golden traces untouched : a note moved
+ *    by one tick, a dot or a clear-cut decoded differently shows up right away.
+ * They are only to be regenerated (-u) when the playback itself changes on purpose,
+ *    or when a song is added to songs.h, the diff being reviewed along with the change.
+ *
+ * Build (from the repository root) :
+ *    g++ -O2 -std=gnu++11 -I. -Iextras/host *.cpp extras/host/Arduino.cpp extras/host/trace.cpp -o mmltrace
+ *    (the golden traces are checked in at the default MMLRESOLUTION, -u writes the ones of another resolution)
+ *
+ * Usage (from the repository root) :
+ *    ./mmltrace [-d directory] [-p passes] [-u]
+ *      -d : directory of the golden traces (default extras/host/golden)
+ *      -p : amount of times each song is played for the throughput (default 1000, 0 to skip it)
+ *      -u : write the traces of the MML code as the golden ones, then check the other paths
+ *    The exit status is 0 if every trace matches, 1 otherwise.
+ * -----------------------------------------------
+ *  Author : Gilles Henrard
+ *  Last edit date : 16/10/2026
+ */
+
+#include "MMLtone.h"
+#include "MMLpacker.h"
+#include "songs.h"
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#define MAXTICKS  100000    //ticks after which a song is considered endless
+#define TRACEPIN  12
+#define MAXLINE   256       //longest line of a trace (comments included)
+
+//ways of playing a song
+#define PATH_CODE     0     //MML code
+#define PATH_EVENTS   1     //pre-decoded events
+#define PATH_PACKED   2     //packed tokens
+#define NBPATHS       3
+
+//songs of the playlist (indexes in songs.h, without any T command,
+//  the tempo of the first song carrying over to the second one)
+#define PLAYLIST_FIRST  0   //melody
+#define PLAYLIST_SECOND 1   //scale
+
+typedef std::chrono::steady_clock traceclock;
+
+static std::vector<std::string>* trace = 0;
+static unsigned long tick = 0;
+
+/****************************************************************
+ * I : Line to add to the current trace (printf() format)       *
+ * P : Record an event of the melody, with the current tick     *
+ * O : /                                                        *
+ ****************************************************************/
+static void append(const char* format, const unsigned int a = 0, const unsigned int b = 0){
+  if(!trace)
+    return;
+
+  char line[MAXLINE];
+  const int length = snprintf(line, sizeof(line), "%lu ", tick);
+  snprintf(line + length, sizeof(line) - length, format, a, b);
+  trace->push_back(line);
+}
+
+/****************************************************************
+ * tone() output, recording the envelope parameters set as well *
+ ****************************************************************/
+class traceOutput : public MMLtoneOutput
+{
+  public:
+      void envelope(const unsigned char pin, const unsigned char param, const unsigned char value){
+        (void)pin;
+        append("env %u %u", param, value);
+      }
+};
+
+static traceOutput output;
+
+/****************************************************************
+ * I : Pin of the tone                                          *
+ *     Frequency played (0 for noTone())                        *
+ * P : Record a tone change in the current trace                *
+ * O : /                                                        *
+ ****************************************************************/
+static void record(uint8_t pin, unsigned int frequency){
+  (void)pin;
+  if(frequency)
+    append("on %u", frequency);
+  else
+    append("off");
+}
+
+/****************************************************************
+ * I : Index of the song                                        *
+ *     Way of playing it (PATH_*)                               *
+ *     Packed tokens of the song                                *
+ * P : Get the handle on a song, for the path given             *
+ * O : Handle on the song                                       *
+ ****************************************************************/
+static MMLsong songOf(const unsigned int s, const unsigned char path, const std::vector<uint8_t>& packed){
+  return (path == PATH_PACKED ? MMLsong(packed.data(), packed.size())
+          : path == PATH_EVENTS ? MMLsong(songs[s].events, songs[s].count)
+          : MMLsong(songs[s].code, songs[s].size));
+}
+
+/****************************************************************
+ * I : Melody loaded with its song(s)                           *
+ *     Trace receiving the events (NULL to only play the song)  *
+ * P : Play a melody until it finishes, as the timer ISR does   *
+ * O : Amount of ticks played                                   *
+ ****************************************************************/
+static unsigned long play(MMLtone& melody, std::vector<std::string>* out){
+  unsigned int bpm = melody.tempo();
+
+  trace = out;
+  melody.setOutput(output);
+  melody.setup();
+  melody.start();
+  for(tick = 0 ; !melody.finished() && tick < MAXTICKS ; tick++)
+  {
+    melody.getNextNote();
+    melody.onTick();
+
+    //the tempo changes are not heard by the output
+    if(melody.tempo() != bpm)
+    {
+      bpm = melody.tempo();
+      append("tempo %u", bpm);
+    }
+  }
+  melody.stop();
+  append("end");
+  trace = 0;
+  return tick;
+}
+
+/****************************************************************
+ * I : Index of the song to play                                *
+ *     Way of playing it (PATH_*)                               *
+ *     Packed tokens of the song                                *
+ *     Trace receiving the events (NULL to only play the song)  *
+ * P : Play a song until it finishes                            *
+ * O : Amount of ticks played                                   *
+ ****************************************************************/
+static unsigned long play(const unsigned int s, const unsigned char path, const std::vector<uint8_t>& packed,
+                          std::vector<std::string>* out){
+  MMLtone melody = (path == PATH_PACKED ? MMLtone(TRACEPIN, packed.data(), packed.size())
+                    : path == PATH_EVENTS ? MMLtone(TRACEPIN, songs[s].events, songs[s].count)
+                    : MMLtone(TRACEPIN, songs[s].code, songs[s].size));
+  return play(melody, out);
+}
+
+/****************************************************************
+ * I : Way of playing the songs (PATH_*)                        *
+ *     Packed tokens of the first and second songs              *
+ *     Trace receiving the events                               *
+ * P : Play the playlist of two songs until it finishes         *
+ * O : Amount of ticks played                                   *
+ ****************************************************************/
+static unsigned long playPlaylist(const unsigned char path, const std::vector<uint8_t>& first,
+                                  const std::vector<uint8_t>& second, std::vector<std::string>* out){
+  MMLplaylist playlist;
+  playlist.add(songOf(PLAYLIST_FIRST, path, first));
+  playlist.add(songOf(PLAYLIST_SECOND, path, second));
+
+  MMLtone melody(TRACEPIN, songs[PLAYLIST_FIRST].code, songs[PLAYLIST_FIRST].size);
+  melody.load(playlist);
+  return play(melody, out);
+}
+
+/****************************************************************
+ * I : Trace of the first song, and its amount of ticks         *
+ *     Trace of the second song                                 *
+ * P : Build the trace of the two songs played without any gap  *
+ *     (the end of the first one left out, the second one       *
+ *     starting on the tick its last note ends)                 *
+ * O : Trace of the playlist                                    *
+ ****************************************************************/
+static std::vector<std::string> chain(const std::vector<std::string>& first, const unsigned long ticks,
+                                      const std::vector<std::string>& second){
+  std::vector<std::string> lines;
+  char end[MAXLINE], off[MAXLINE];
+  snprintf(end, sizeof(end), "%lu end", ticks);
+  snprintf(off, sizeof(off), "%lu off", ticks);
+
+  for(size_t i = 0 ; i < first.size() ; i++)
+    if(first[i] != end && first[i] != off)
+      lines.push_back(first[i]);
+
+  for(size_t i = 0 ; i < second.size() ; i++)
+  {
+    char line[MAXLINE];
+    char* rest = 0;
+    const unsigned long t = strtoul(second[i].c_str(), &rest, 10);
+    snprintf(line, sizeof(line), "%lu%s", t + ticks - 1, rest);
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+/****************************************************************
+ * I : Path of the golden trace                                 *
+ *     Vector receiving its events (comments left out)          *
+ * P : Read a golden trace                                      *
+ * O : true if read, false otherwise                            *
+ ****************************************************************/
+static bool readTrace(const char* path, std::vector<std::string>& lines){
+  FILE* f = fopen(path, "r");
+  if(!f)
+    return false;
+
+  char line[MAXLINE];
+  while(fgets(line, sizeof(line), f))
+  {
+    line[strcspn(line, "\r\n")] = '\0';
+    if(line[0] != '#' && line[0] != '\0')
+      lines.push_back(line);
+  }
+  fclose(f);
+  return true;
+}
+
+/****************************************************************
+ * I : Path of the golden trace                                 *
+ *     Name of the song                                         *
+ *     Events of the song                                       *
+ * P : Write a golden trace                                     *
+ * O : true if written, false otherwise                         *
+ ****************************************************************/
+static bool writeTrace(const char* path, const char* name, const std::vector<std::string>& lines){
+  FILE* f = fopen(path, "w");
+  if(!f)
+    return false;
+
+  fprintf(f, "# %s : MML code played at %d ticks per whole note (see trace.cpp)\n", name, MMLRESOLUTION);
+  for(size_t i = 0 ; i < lines.size() ; i++)
+    fprintf(f, "%s\n", lines[i].c_str());
+  fclose(f);
+  return true;
+}
+
+/****************************************************************
+ * I : Golden trace                                             *
+ *     Trace recorded                                           *
+ * P : Find the first event which differs between two traces    *
+ * O : Index of that event (the size of both if none)           *
+ ****************************************************************/
+static size_t compare(const std::vector<std::string>& golden, const std::vector<std::string>& lines){
+  size_t i = 0;
+  while(i < golden.size() && i < lines.size() && golden[i] == lines[i])
+    i++;
+  return i;
+}
+
+/****************************************************************
+ * I : Program name                                             *
+ * P : Print the usage of the program                           *
+ * O : /                                                        *
+ ****************************************************************/
+static void usage(const char* name){
+  fprintf(stderr, "usage : %s [-d directory] [-p passes] [-u]\n", name);
+}
+
+int main(int argc, char* argv[]){
+  const char* paths[NBPATHS] = {"MML code", "pre-decoded events", "packed tokens"};
+  const char* directory = "extras/host/golden";
+  unsigned int passes = 1000;
+  bool update = false;
+
+  //parse the arguments
+  for(int a = 1 ; a < argc ; a++)
+  {
+    if(!strcmp(argv[a], "-u"))
+      update = true;
+    else if(!strcmp(argv[a], "-d") && a + 1 < argc)
+      directory = argv[++a];
+    else if(!strcmp(argv[a], "-p") && a + 1 < argc)
+      passes = (unsigned int)strtoul(argv[++a], NULL, 10);
+    else
+    {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  hostToneHook = record;
+  unsigned int failures = 0;
+
+  printf("%-8s %-20s %8s   %s\n", "song", "path", "ticks", "result");
+  for(unsigned int s = 0 ; s < NBSONGS ; s++)
+  {
+    const std::vector<uint8_t> packed = MMLpack(songs[s].events, songs[s].count);
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s.%d.trace", directory, songs[s].name, MMLRESOLUTION);
+
+    //the golden trace is the one of the MML code when updated
+    std::vector<std::string> golden;
+    if(update)
+    {
+      play(s, PATH_CODE, packed, &golden);
+      if(!writeTrace(path, songs[s].name, golden))
+      {
+        fprintf(stderr, "%s : cannot write the golden trace\n", path);
+        return 1;
+      }
+    }
+    else if(!readTrace(path, golden))
+    {
+      printf("%-8s %-20s %8s   no golden trace (%s)\n", songs[s].name, "", "", path);
+      failures++;
+      continue;
+    }
+
+    for(unsigned char p = 0 ; p < NBPATHS ; p++)
+    {
+      std::vector<std::string> lines;
+      const unsigned long ticks = play(s, p, packed, &lines);
+      const size_t i = compare(golden, lines);
+
+      if(i == golden.size() && i == lines.size())
+      {
+        printf("%-8s %-20s %8lu   ok\n", songs[s].name, paths[p], ticks);
+        continue;
+      }
+
+      printf("%-8s %-20s %8lu   event %zu : expected \"%s\", got \"%s\"\n", songs[s].name, paths[p], ticks, i + 1,
+             (i < golden.size() ? golden[i].c_str() : "(end of trace)"), (i < lines.size() ? lines[i].c_str() : "(end of trace)"));
+      failures++;
+    }
+  }
+
+  //playlist of two songs, against its golden trace and the traces of both songs
+  const std::vector<uint8_t> firstpacked = MMLpack(songs[PLAYLIST_FIRST].events, songs[PLAYLIST_FIRST].count);
+  const std::vector<uint8_t> secondpacked = MMLpack(songs[PLAYLIST_SECOND].events, songs[PLAYLIST_SECOND].count);
+  char path[512];
+  snprintf(path, sizeof(path), "%s/playlist.%d.trace", directory, MMLRESOLUTION);
+
+  std::vector<std::string> golden;
+  if(update)
+  {
+    playPlaylist(PATH_CODE, firstpacked, secondpacked, &golden);
+    if(!writeTrace(path, "playlist", golden))
+    {
+      fprintf(stderr, "%s : cannot write the golden trace\n", path);
+      return 1;
+    }
+  }
+  else if(!readTrace(path, golden))
+  {
+    printf("%-8s %-20s %8s   no golden trace (%s)\n", "playlist", "", "", path);
+    failures++;
+  }
+
+  for(unsigned char p = 0 ; p < NBPATHS && !golden.empty() ; p++)
+  {
+    std::vector<std::string> lines, first, second;
+    const unsigned long ticks = playPlaylist(p, firstpacked, secondpacked, &lines);
+    const unsigned long firstticks = play(PLAYLIST_FIRST, p, firstpacked, &first);
+    play(PLAYLIST_SECOND, p, secondpacked, &second);
+    const std::vector<std::string> chained = chain(first, firstticks, second);
+    const size_t i = compare(golden, lines), c = compare(chained, lines);
+
+    if(i != golden.size() || i != lines.size())
+    {
+      printf("%-8s %-20s %8lu   event %zu : expected \"%s\", got \"%s\"\n", "playlist", paths[p], ticks, i + 1,
+             (i < golden.size() ? golden[i].c_str() : "(end of trace)"), (i < lines.size() ? lines[i].c_str() : "(end of trace)"));
+      failures++;
+    }
+    else if(c != chained.size() || c != lines.size())
+    {
+      printf("%-8s %-20s %8lu   boundary, event %zu : expected \"%s\", got \"%s\"\n", "playlist", paths[p], ticks, c + 1,
+             (c < chained.size() ? chained[c].c_str() : "(end of trace)"), (c < lines.size() ? lines[c].c_str() : "(end of trace)"));
+      failures++;
+    }
+    else
+      printf("%-8s %-20s %8lu   ok\n", "playlist", paths[p], ticks);
+  }
+
+  //throughput of the MML code, on the same corpus
+  if(passes)
+  {
+    printf("\nthroughput of the MML code (%u passes per song)\n", passes);
+    for(unsigned int s = 0 ; s < NBSONGS ; s++)
+    {
+      const std::vector<uint8_t> none;
+      unsigned long long ticks = 0;
+      traceclock::time_point start = traceclock::now();
+      for(unsigned int p = 0 ; p < passes ; p++)
+        ticks += play(s, PATH_CODE, none, 0);
+      const unsigned long long nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(traceclock::now() - start).count();
+
+      printf("%-8s %.0f ticks/s\n", songs[s].name, ticks * 1e9 / (nanos ? nanos : 1));
+    }
+  }
+
+  if(failures)
+    printf("\n%u trace(s) differ from the golden ones\n", failures);
+  else
+    printf("\nall traces match the golden ones\n");
+  return (failures ? 1 : 0);
+}
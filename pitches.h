@@ -1,6 +1,15 @@
 #ifndef INCLUDE_PITCHES_H
 #define INCLUDE_PITCHES_H
 
+#include <Arduino.h>
+#include "MMLsequence.h"
+
+//frequency of the A at the octave 4 (in Hz), from which all the others are derived
+// (e.g. 440, 442 for some orchestras, 415 for baroque music)
+#ifndef REFPITCH
+#define REFPITCH 440
+#endif
+
 #define TYP_A 0
 #define TYP_B 2
 #define TYP_C 3
@@ -116,5 +125,54 @@
 #define NOTE_A8   96
 #define NOTE_As8  97
 #define NOTE_B8   98
+#define NBNOTES   99
+
+#define MMLMAXDETUNE  100       //largest detune (in cents, a semitone : transpose beyond)
+#define MMLUNITY      0x8000    //ratio of 1 (1.15 fixed point)
+
+/****************************************************************
+ * Equal temperament frequencies, computed at compile time      *
+ ****************************************************************/
+struct MMLpitch{
+  //ratio between a note and the A of its octave (2^(semitones/12))
+  static constexpr double semitone(const unsigned char k){
+    return (k == 0 ? 1.0 : k == 1 ? 1.0594630943592953 : k == 2 ? 1.1224620483093730
+          : k == 3 ? 1.1892071150027210 : k == 4 ? 1.2599210498948732 : k == 5 ? 1.3348398541700344
+          : k == 6 ? 1.4142135623730951 : k == 7 ? 1.4983070768766815 : k == 8 ? 1.5874010519681994
+          : k == 9 ? 1.6817928305074290 : k == 10 ? 1.7817974362806785 : 1.8877486253633868);
+  }
+
+  //frequency of the A of an octave
+  static constexpr double octave(const unsigned char o){
+    return (o == 0 ? REFPITCH / 16.0 : 2.0 * octave(o - 1));
+  }
+
+  //frequency of a note, rounded to the nearest Hz
+  static constexpr uint16_t frequency(const unsigned char note){
+    return (uint16_t)(octave(note / 12) * semitone(note % 12) + 0.5);
+  }
+
+  //ratio of a detune, 2^(cents / 1200) in 1.15 fixed point, from the third order series of e^x
+  //  with x = cents * ln(2) / 1200 (4846 / 256 per cent in 1.15 : about 0.1 cent off at most, up to a semitone)
+  static constexpr uint16_t ratio(const int cents){
+    return series(((long)cents * 4846) / 256);
+  }
+
+  static constexpr uint16_t series(const long x){
+    return (uint16_t)(MMLUNITY + x + ((x * x) >> 16) + ((((x * x) >> 15) * x) >> 15) / 6);
+  }
+};
+
+template<class Sequence = MMLmakeSequence<NBNOTES>::type>
+struct MMLpitchTable;
+
+template<unsigned int... I>
+struct MMLpitchTable<MMLsequence<I...> >{
+  static constexpr uint16_t frequencies[NBNOTES] PROGMEM = {MMLpitch::frequency(I)...};
+};
+
+template<unsigned int... I>
+constexpr uint16_t MMLpitchTable<MMLsequence<I...> >::frequencies[NBNOTES] PROGMEM;
+
 
 #endif